@@ -0,0 +1,233 @@
+#include "analysis.h"
+
+#include "profiler.h"
+
+AnalysisWorker::AnalysisWorker(size_t hashMegabytes, int threads)
+    : engine(hashMegabytes, threads), hashMegabytes(hashMegabytes), threads(threads) {
+    thread = std::thread(&AnalysisWorker::loop, this);
+}
+
+AnalysisWorker::~AnalysisWorker() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        quit = true;
+        cancel = true;
+    }
+    wake.notify_one();
+    thread.join();
+}
+
+// Applied by the worker before its next search, since resizing the table
+// under a running search is not allowed.
+void AnalysisWorker::setOptions(size_t hash, int threadCount) {
+    std::lock_guard<std::mutex> lock(mutex);
+    hashMegabytes = hash;
+    threads = threadCount;
+}
+
+void AnalysisWorker::start(const Position& pos, const std::vector<uint64_t>& history) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        job.position = pos;
+        job.history = history;
+        job.hashMegabytes = hashMegabytes;
+        job.threads = threads;
+        pending = true;
+        cancel = true;
+
+        latest = AnalysisInfo();
+        latest.generation = ++generation;
+        latest.searching = true;
+        changed = true;
+    }
+    wake.notify_one();
+}
+
+void AnalysisWorker::stop() {
+    std::lock_guard<std::mutex> lock(mutex);
+    pending = false;
+    cancel = true;
+    if (latest.searching) {
+        latest.searching = false;
+        changed = true;
+    }
+}
+
+bool AnalysisWorker::poll(AnalysisInfo& info) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!changed) return false;
+    info = latest;
+    changed = false;
+    return true;
+}
+
+void AnalysisWorker::publish(uint64_t searchGeneration, const SearchResult& result, bool searching) {
+    std::lock_guard<std::mutex> lock(mutex);
+    // A result of a cancelled search must not overwrite the newer position.
+    if (searchGeneration != generation) return;
+    if (result.depth > 0) {
+        latest.depth = result.depth;
+        latest.score = result.score;
+        latest.pv = result.pv;
+    }
+    latest.nodes = result.nodes;
+    latest.seconds = result.seconds;
+    latest.searching = searching && latest.searching;
+    changed = true;
+}
+
+void AnalysisWorker::loop() {
+    size_t engineHash = hashMegabytes;
+    int engineThreads = threads;
+
+    while (true) {
+        Job current;
+        uint64_t searchGeneration;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this]() { return pending || quit; });
+            if (quit) return;
+            current = job;
+            searchGeneration = generation;
+            pending = false;
+            cancel = false;
+        }
+
+        if (current.hashMegabytes != engineHash) {
+            engineHash = current.hashMegabytes;
+            engine.setHashSize(engineHash);
+        }
+        if (current.threads != engineThreads) {
+            engineThreads = current.threads;
+            engine.setThreads(engineThreads);
+        }
+
+        PROFILE_ZONE("AnalysisWorker::job");
+        SearchLimits limits;
+        limits.cancel = &cancel;
+        engine.setGameHistory(current.history);
+        SearchResult result = engine.search(current.position, limits, [&](const SearchResult& info) {
+            publish(searchGeneration, info, true);
+        });
+        publish(searchGeneration, result, false);
+    }
+}
+
+MoveWorker::MoveWorker(size_t hashMegabytes, int threads)
+    : engine(hashMegabytes, threads), mcts(hashMegabytes, threads), hashMegabytes(hashMegabytes), threads(threads) {
+    thread = std::thread(&MoveWorker::loop, this);
+}
+
+MoveWorker::~MoveWorker() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        quit = true;
+        cancel = true;
+    }
+    wake.notify_one();
+    thread.join();
+}
+
+void MoveWorker::setOptions(size_t hash, int threadCount) {
+    std::lock_guard<std::mutex> lock(mutex);
+    hashMegabytes = hash;
+    threads = threadCount;
+}
+
+void MoveWorker::newGame() {
+    std::lock_guard<std::mutex> lock(mutex);
+    newGamePending = true;
+}
+
+void MoveWorker::start(const Position& pos, const std::vector<uint64_t>& history, bool useMcts,
+                       const SearchLimits& limits) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        job.position = pos;
+        job.history = history;
+        job.useMcts = useMcts;
+        job.limits = limits;
+        job.hashMegabytes = hashMegabytes;
+        job.threads = threads;
+        job.newGame = newGamePending;
+        newGamePending = false;
+        pending = true;
+        cancel = true;
+        ++generation;
+        ready = false;
+    }
+    wake.notify_one();
+}
+
+void MoveWorker::stop() {
+    std::lock_guard<std::mutex> lock(mutex);
+    // A cancelled job's newGame still has to reach the engine.
+    if (pending && job.newGame) newGamePending = true;
+    pending = false;
+    cancel = true;
+    ++generation;
+    ready = false;
+}
+
+bool MoveWorker::poll(ComputerMove& move) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!ready) return false;
+    move = latest;
+    ready = false;
+    return true;
+}
+
+void MoveWorker::loop() {
+    size_t engineHash = hashMegabytes;
+    int engineThreads = threads;
+
+    while (true) {
+        Job current;
+        uint64_t searchGeneration;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this]() { return pending || quit; });
+            if (quit) return;
+            current = job;
+            searchGeneration = generation;
+            pending = false;
+            cancel = false;
+        }
+
+        if (current.hashMegabytes != engineHash) {
+            engineHash = current.hashMegabytes;
+            engine.setHashSize(engineHash);
+            // The MCTS tree gets the same memory budget as the hash table.
+            mcts.setTreeSize(engineHash);
+        }
+        if (current.threads != engineThreads) {
+            engineThreads = current.threads;
+            engine.setThreads(engineThreads);
+            mcts.setThreads(engineThreads);
+        }
+        if (current.newGame) engine.newGame();
+
+        PROFILE_ZONE("MoveWorker::job");
+        SearchLimits limits = current.limits;
+        limits.cancel = &cancel;
+        ComputerMove result;
+        result.mcts = current.useMcts;
+        if (current.useMcts) {
+            result.mctsResult = mcts.search(current.position, limits);
+            result.mctsArenaBytes = mcts.arenaBytes();
+            result.hasMove = result.mctsResult.hasMove;
+            result.move = result.mctsResult.bestMove;
+        } else {
+            engine.setGameHistory(current.history);
+            SearchResult search = engine.search(current.position, limits);
+            result.hasMove = search.hasMove;
+            result.move = search.bestMove;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        // The move of a cancelled search is for a position no longer shown.
+        if (searchGeneration != generation) continue;
+        latest = result;
+        ready = true;
+    }
+}
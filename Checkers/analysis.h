@@ -0,0 +1,136 @@
+#ifndef ANALYSIS_H
+#define ANALYSIS_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "bitboard.h"
+#include "mcts.h"
+#include "search.h"
+
+struct AnalysisInfo {
+    uint64_t generation = 0;    // bumped by every start(), identifies the position
+    bool searching = false;
+    int depth = 0;
+    int score = 0;              // from the analysed side to move's view
+    uint64_t nodes = 0;
+    double seconds = 0;
+    std::vector<Move> pv;
+};
+
+// Infinite search of one position on a private engine and thread, for the
+// GUI's analysis mode. start() and stop() only raise a cancellation flag and
+// hand over the new job, so the caller never waits for the search to unwind;
+// results are picked up by polling.
+class AnalysisWorker {
+public:
+    explicit AnalysisWorker(size_t hashMegabytes = 64, int threads = 1);
+    ~AnalysisWorker();
+
+    void setOptions(size_t hashMegabytes, int threads);
+
+    // Cancels whatever runs and analyses `pos`; `history` holds the keys of
+    // the game so far, `pos` last.
+    void start(const Position& pos, const std::vector<uint64_t>& history);
+    void stop();
+
+    // Copies the latest result into `info` if it changed since the last call.
+    bool poll(AnalysisInfo& info);
+
+private:
+    struct Job {
+        Position position;
+        std::vector<uint64_t> history;
+        size_t hashMegabytes = 0;
+        int threads = 0;
+    };
+
+    void loop();
+    void publish(uint64_t generation, const SearchResult& result, bool searching);
+
+    Engine engine;
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::atomic<bool> cancel{false};
+
+    // Guarded by `mutex`.
+    Job job;
+    bool pending = false;
+    bool quit = false;
+    size_t hashMegabytes;
+    int threads;
+    uint64_t generation = 0;
+    AnalysisInfo latest;
+    bool changed = false;
+};
+
+// The reply of a MoveWorker search. MCTS statistics are only filled in when
+// `mcts` ran.
+struct ComputerMove {
+    bool hasMove = false;
+    Move move;
+    bool mcts = false;
+    MctsResult mctsResult;
+    size_t mctsArenaBytes = 0;
+};
+
+// The computer player's move searches, on private engines and a thread of
+// their own so the GUI keeps drawing and handling events while the engine
+// thinks. Like AnalysisWorker, start() and stop() never wait for a search to
+// unwind, and the move is picked up by polling.
+class MoveWorker {
+public:
+    explicit MoveWorker(size_t hashMegabytes = 16, int threads = 1);
+    ~MoveWorker();
+
+    // Both applied by the worker before its next search.
+    void setOptions(size_t hashMegabytes, int threads);
+    void newGame();
+
+    // Cancels whatever runs and searches `pos` within `limits`, with MCTS or
+    // the alpha-beta engine; `history` holds the keys of the game so far.
+    void start(const Position& pos, const std::vector<uint64_t>& history, bool useMcts,
+               const SearchLimits& limits);
+    void stop();
+
+    // Hands over the move of the latest start() once, when it is found.
+    bool poll(ComputerMove& move);
+
+private:
+    struct Job {
+        Position position;
+        std::vector<uint64_t> history;
+        bool useMcts = false;
+        SearchLimits limits;
+        size_t hashMegabytes = 0;
+        int threads = 0;
+        bool newGame = false;
+    };
+
+    void loop();
+
+    Engine engine;
+    MctsEngine mcts;
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::atomic<bool> cancel{false};
+
+    // Guarded by `mutex`.
+    Job job;
+    bool pending = false;
+    bool quit = false;
+    size_t hashMegabytes;
+    int threads;
+    bool newGamePending = false;
+    uint64_t generation = 0;
+    ComputerMove latest;
+    bool ready = false;
+};
+
+#endif // ANALYSIS_H
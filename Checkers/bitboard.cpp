@@ -0,0 +1,36 @@
+#include "bitboard.h"
+
+#include "rules.h"
+
+Bitboard capturers(const Position& pos) {
+    return RussianDraughts::capturers(pos);
+}
+
+bool hasCapture(const Position& pos) {
+    return capturers(pos) != 0;
+}
+
+Bitboard movers(const Position& pos) {
+    return RussianDraughts::movers(pos);
+}
+
+void generateMoves(const Position& pos, MoveList& moves) {
+    RussianDraughts::generateMoves(pos, moves);
+}
+
+void generateMoves(const Position& pos, Bitboard jumpers, MoveList& moves) {
+    RussianDraughts::generateMoves(pos, jumpers, moves);
+}
+
+void makeMove(Position& pos, const Move& move) {
+    UndoInfo undo;
+    makeMove(pos, move, undo);
+}
+
+void makeMove(Position& pos, const Move& move, UndoInfo& undo) {
+    RussianDraughts::makeMove(pos, move, undo);
+}
+
+void unmakeMove(Position& pos, const Move& move, const UndoInfo& undo) {
+    RussianDraughts::unmakeMove(pos, move, undo);
+}
@@ -0,0 +1,180 @@
+#ifndef BITBOARD_H
+#define BITBOARD_H
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+#include "geometry.h"
+
+// Pieces, moves and positions for any board geometry, and the Russian 8x8
+// instantiation the engine, tablebases and tools are built on. Rule logic for
+// every variant lives in rules.h; the free functions below are the Russian
+// rule set on the standard 32-square board.
+
+enum class PieceType { None, Man, King };
+enum class PieceColor { None, White, Black };
+
+struct Piece {
+    PieceType type = PieceType::None;
+    PieceColor color = PieceColor::None;
+};
+
+inline PieceColor opponent(PieceColor color) {
+    return color == PieceColor::White ? PieceColor::Black : PieceColor::White;
+}
+
+typedef BoardGeometry<8> StandardBoard;
+typedef StandardBoard::Mask Bitboard;
+
+const int NUM_SQUARES = StandardBoard::SQUARES;
+const int MAX_CAPTURE_PATH = StandardBoard::MAX_CAPTURE_PATH;
+
+const Bitboard WHITE_PROMOTION_ROW = StandardBoard::WHITE_PROMOTION;
+const Bitboard BLACK_PROMOTION_ROW = StandardBoard::BLACK_PROMOTION;
+
+inline Bitboard squareBit(int sq) { return StandardBoard::bit(sq); }
+inline int squareRow(int sq) { return StandardBoard::row(sq); }
+inline int squareCol(int sq) { return StandardBoard::col(sq); }
+inline int squareIndex(int row, int col) { return StandardBoard::index(row, col); }
+inline Bitboard shift(Bitboard b, int dir) { return StandardBoard::shift(b, dir); }
+
+template <typename Geometry>
+struct BasicMove {
+    typedef typename Geometry::Mask Mask;
+
+    uint8_t from = 0;
+    uint8_t to = 0;
+    uint8_t pathLength = 0;          // landing squares, 1 for a quiet move
+    bool promotion = false;          // man is crowned, possibly mid-capture
+    uint8_t path[Geometry::MAX_CAPTURE_PATH] = {};
+    Mask captured = 0;
+
+    bool isCapture() const { return captured != 0; }
+};
+
+typedef BasicMove<StandardBoard> Move;
+
+// Far above any reachable position (twelve kings have at most 156 steps);
+// also keeps every index below the transposition table's NO_TT_MOVE marker.
+const int MAX_MOVES = 255;
+
+// Fixed-capacity, stack-allocatable move list with the subset of the
+// std::vector interface the generators and callers use. MAX_MOVES also holds
+// the 10x10 variants' flying-king captures; running past it would cut the
+// legal moves short, which debug builds stop on.
+template <typename MoveType>
+class BasicMoveList {
+public:
+    BasicMoveList() {}
+    BasicMoveList(const BasicMoveList& other) : count(other.count) {
+        for (int i = 0; i < count; ++i) moves[i] = other.moves[i];
+    }
+    BasicMoveList& operator=(const BasicMoveList& other) {
+        count = other.count;
+        for (int i = 0; i < count; ++i) moves[i] = other.moves[i];
+        return *this;
+    }
+
+    void clear() { count = 0; }
+    void push_back(const MoveType& move) {
+        assert(count < MAX_MOVES && "move list overflow");
+        if (count < MAX_MOVES) moves[count++] = move;
+    }
+
+    size_t size() const { return static_cast<size_t>(count); }
+    bool empty() const { return count == 0; }
+    const MoveType& operator[](size_t i) const { return moves[i]; }
+    MoveType& operator[](size_t i) { return moves[i]; }
+    const MoveType& front() const { return moves[0]; }
+    const MoveType* begin() const { return moves; }
+    const MoveType* end() const { return moves + count; }
+
+private:
+    int count = 0;
+    // Left uninitialized: only the first `count` entries are ever read.
+    union {
+        MoveType moves[MAX_MOVES];
+    };
+};
+
+typedef BasicMoveList<Move> MoveList;
+
+template <typename Geometry>
+struct BasicPosition {
+    typedef typename Geometry::Mask Mask;
+
+    Mask white = 0;
+    Mask black = 0;
+    Mask kings = 0;
+    PieceColor sideToMove = PieceColor::White;
+
+    static BasicPosition initial() {
+        BasicPosition pos;
+        pos.white = Geometry::WHITE_START;
+        pos.black = Geometry::BLACK_START;
+        return pos;
+    }
+
+    Mask occupied() const { return white | black; }
+    Mask empty() const { return ~occupied() & Geometry::BOARD; }
+    Mask own() const { return sideToMove == PieceColor::White ? white : black; }
+    Mask enemy() const { return sideToMove == PieceColor::White ? black : white; }
+
+    Piece pieceAt(int sq) const {
+        Mask bit = Geometry::bit(sq);
+        Piece piece;
+        if (white & bit) piece.color = PieceColor::White;
+        else if (black & bit) piece.color = PieceColor::Black;
+        else return piece;
+        piece.type = (kings & bit) ? PieceType::King : PieceType::Man;
+        return piece;
+    }
+
+    void setPiece(int sq, Piece piece) {
+        Mask bit = Geometry::bit(sq);
+        white &= ~bit;
+        black &= ~bit;
+        kings &= ~bit;
+        if (piece.color == PieceColor::White) white |= bit;
+        if (piece.color == PieceColor::Black) black |= bit;
+        if (piece.color != PieceColor::None && piece.type == PieceType::King) kings |= bit;
+    }
+
+    bool operator==(const BasicPosition& other) const {
+        return white == other.white && black == other.black &&
+               kings == other.kings && sideToMove == other.sideToMove;
+    }
+};
+
+typedef BasicPosition<StandardBoard> Position;
+
+// What makeMove destroys beyond the move itself.
+template <typename Geometry>
+struct BasicUndoInfo {
+    typename Geometry::Mask capturedKings = 0;
+    bool wasKing = false;
+};
+
+typedef BasicUndoInfo<StandardBoard> UndoInfo;
+
+// Pieces of the side to move that have at least one capture available.
+Bitboard capturers(const Position& pos);
+bool hasCapture(const Position& pos);
+
+// Pieces of the side to move that have a quiet (non-capturing) step. Only
+// meaningful as a legality test when capturers() is empty.
+Bitboard movers(const Position& pos);
+
+// Fills `moves` with every legal move. Captures are mandatory and are emitted
+// as complete multi-jump sequences; captured pieces stay on the board as
+// blockers until the sequence ends and cannot be jumped twice.
+void generateMoves(const Position& pos, MoveList& moves);
+// Same, with capturers(pos) already known.
+void generateMoves(const Position& pos, Bitboard jumpers, MoveList& moves);
+
+void makeMove(Position& pos, const Move& move);
+void makeMove(Position& pos, const Move& move, UndoInfo& undo);
+void unmakeMove(Position& pos, const Move& move, const UndoInfo& undo);
+
+#endif // BITBOARD_H
@@ -1,414 +1,534 @@
 #include "checkers.h"
 
-CheckersGame::CheckersGame() : window(sf::VideoMode(WINDOW_SIZE, WINDOW_SIZE), "Шашки") {
-    window.setVerticalSyncEnabled(true);
-    board.resize(BOARD_SIZE, std::vector<Piece>(BOARD_SIZE));
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+#include "eval.h"
+#include "notation.h"
+#include "profiler.h"
+
+namespace {
+
+// Sizes relative to a cell, so every board size fills the window.
+const float PIECE_RADIUS = 0.4f;
+const float PIECE_OUTLINE = 2;
+const float SELECTION_RADIUS = 0.45f;
+const float SELECTION_OUTLINE = 3;
+const float HIGHLIGHT_INSET = 0.05f;
+const int CIRCLE_POINTS = 30;
+const int KING_POINTS = 6;
+const float ANALYSIS_WIDTH = 10;
+const int ANALYSIS_PV_MOVES = 8;
+const int FRAME_MS = 16;
+
+const sf::Color LIGHT_CELL(210, 180, 140);
+const sf::Color DARK_CELL(139, 69, 19);
+const sf::Color HIGHLIGHT(0, 255, 0, 100);
+const sf::Color BLACK_PIECE(150, 0, 0);
+const sf::Color BEST_MOVE(0, 120, 255, 170);
+const sf::Color REPLY_MOVE(255, 140, 0, 120);
+
+// F1/F2 cycle a side through human, alpha-beta and MCTS.
+PlayerType nextPlayerType(PlayerType type) {
+    switch (type) {
+    case PlayerType::Human:    return PlayerType::Computer;
+    case PlayerType::Computer: return PlayerType::Mcts;
+    default:                   return PlayerType::Human;
+    }
+}
+
+sf::Vector2f polygonPoint(sf::Vector2f center, float radius, int index, int points) {
+    // Same orientation as sf::CircleShape: the first point is at the top.
+    float angle = index * 2 * 3.14159265f / points - 3.14159265f / 2;
+    return sf::Vector2f(center.x + radius * std::cos(angle), center.y + radius * std::sin(angle));
+}
+
+void appendQuad(sf::VertexArray& vertices, sf::Vector2f topLeft, sf::Vector2f size, sf::Color color) {
+    sf::Vector2f topRight(topLeft.x + size.x, topLeft.y);
+    sf::Vector2f bottomLeft(topLeft.x, topLeft.y + size.y);
+    sf::Vector2f bottomRight(topLeft.x + size.x, topLeft.y + size.y);
+    vertices.append(sf::Vertex(topLeft, color));
+    vertices.append(sf::Vertex(topRight, color));
+    vertices.append(sf::Vertex(bottomRight, color));
+    vertices.append(sf::Vertex(topLeft, color));
+    vertices.append(sf::Vertex(bottomRight, color));
+    vertices.append(sf::Vertex(bottomLeft, color));
+}
+
+void appendSegment(sf::VertexArray& vertices, sf::Vector2f from, sf::Vector2f to, float width, sf::Color color) {
+    sf::Vector2f direction = to - from;
+    float length = std::sqrt(direction.x * direction.x + direction.y * direction.y);
+    if (length == 0) return;
+    sf::Vector2f normal(-direction.y / length * width / 2, direction.x / length * width / 2);
+    vertices.append(sf::Vertex(from + normal, color));
+    vertices.append(sf::Vertex(to + normal, color));
+    vertices.append(sf::Vertex(to - normal, color));
+    vertices.append(sf::Vertex(from + normal, color));
+    vertices.append(sf::Vertex(to - normal, color));
+    vertices.append(sf::Vertex(from - normal, color));
+}
 
-    pieceShape.setRadius(CELL_SIZE / 2 - 10);
-    pieceShape.setOutlineThickness(2);
-    pieceShape.setOutlineColor(sf::Color::Black);
+void appendPolygon(sf::VertexArray& vertices, sf::Vector2f center, float radius, int points, sf::Color color) {
+    for (int i = 0; i < points; ++i) {
+        vertices.append(sf::Vertex(center, color));
+        vertices.append(sf::Vertex(polygonPoint(center, radius, i, points), color));
+        vertices.append(sf::Vertex(polygonPoint(center, radius, i + 1, points), color));
+    }
+}
 
-    kingShape.setRadius(CELL_SIZE / 2 - 10);
-    kingShape.setOutlineThickness(2);
-    kingShape.setOutlineColor(sf::Color::Black);
-    kingShape.setPointCount(6);
+void appendRing(sf::VertexArray& vertices, sf::Vector2f center, float inner, float outer, int points, sf::Color color) {
+    for (int i = 0; i < points; ++i) {
+        sf::Vector2f innerA = polygonPoint(center, inner, i, points);
+        sf::Vector2f innerB = polygonPoint(center, inner, i + 1, points);
+        sf::Vector2f outerA = polygonPoint(center, outer, i, points);
+        sf::Vector2f outerB = polygonPoint(center, outer, i + 1, points);
+        vertices.append(sf::Vertex(innerA, color));
+        vertices.append(sf::Vertex(outerA, color));
+        vertices.append(sf::Vertex(outerB, color));
+        vertices.append(sf::Vertex(innerA, color));
+        vertices.append(sf::Vertex(outerB, color));
+        vertices.append(sf::Vertex(innerB, color));
+    }
+}
+
+} // namespace
+
+CheckersGame::CheckersGame(const std::string& variantName, bool openWindow)
+    : variant(createVariant(variantName)),
+      boardVertices(sf::Triangles),
+      overlayVertices(sf::Triangles) {
+    if (!variant) variant = createVariant("russian");
+    boardSize = variant->boardSize();
+    cellSize = static_cast<float>(WINDOW_SIZE) / boardSize;
+    if (openWindow) {
+        window.create(sf::VideoMode(WINDOW_SIZE, WINDOW_SIZE), "Шашки");
+        window.setVerticalSyncEnabled(true);
+    }
 
     if (!font.loadFromFile("arial.ttf")) {
         font.loadFromMemory(NULL, 0);
     }
+    statusText.setFont(font);
+    statusText.setCharacterSize(24);
+    statusText.setFillColor(sf::Color::Black);
+    statusText.setPosition(10, 10);
+    analysisText.setFont(font);
+    analysisText.setCharacterSize(18);
+    analysisText.setFillColor(sf::Color::Black);
+    analysisText.setPosition(10, WINDOW_SIZE - 30);
+
+    buildBoard();
+
+    engineLimits.moveTimeMs = 1000;
 
     initializeBoard();
 }
 
+void CheckersGame::setPlayer(PieceColor color, PlayerType type) {
+    if (color == PieceColor::White) whitePlayer = type;
+    else blackPlayer = type;
+    computerStalled = false;
+    cancelComputerMove();
+    dirty = true;
+}
+
+void CheckersGame::setEngineOptions(int moveTimeMs, size_t hashMegabytes, int threads) {
+    engineLimits.moveTimeMs = moveTimeMs;
+    moveWorker.setOptions(hashMegabytes, threads);
+    analysis.setOptions(hashMegabytes, threads);
+}
+
+bool CheckersGame::setOpeningBook(const std::string& path) {
+    return openingBook.open(path);
+}
+
 void CheckersGame::initializeBoard() {
-    for (int row = 0; row < 3; ++row) {
-        for (int col = 0; col < BOARD_SIZE; ++col) {
-            if ((row + col) % 2 == 1) {
-                board[row][col] = {PieceType::Man, PieceColor::White};
-            }
-        }
-    }
+    variant->reset();
+    redoMoves.clear();
+    moveWorker.newGame();
+    syncPosition();
+}
 
-    for (int row = 5; row < BOARD_SIZE; ++row) {
-        for (int col = 0; col < BOARD_SIZE; ++col) {
-            if ((row + col) % 2 == 1) {
-                board[row][col] = {PieceType::Man, PieceColor::Black};
-            }
-        }
-    }
+// Refreshes everything derived from the game after the move list changed.
+void CheckersGame::syncPosition() {
+    displayBoard.resize(variant->squareCount());
+    for (int sq = 0; sq < variant->squareCount(); ++sq) displayBoard[sq] = variant->pieceAt(sq);
+    if (GameState* game = variant->engineGame()) game->keyHistory(positionHistory);
+    isMoving = false;
+    computerStalled = false;
+    cancelComputerMove();
+    clearPossibleMoves();
+    checkForMandatoryCaptures();
+    restartAnalysis();
+}
+
+void CheckersGame::toggleAnalysis() {
+    if (!variant->engineGame()) return;
+    analysisMode = !analysisMode;
+    analysisInfo = AnalysisInfo();
+    if (analysisMode) restartAnalysis();
+    else analysis.stop();
+    dirty = true;
+}
+
+// Only hands the position to the worker: the search being replaced unwinds
+// on its own thread while the UI carries on.
+void CheckersGame::restartAnalysis() {
+    if (!analysisMode) return;
+    GameState* game = variant->engineGame();
+    if (!game || isComputerTurn() || game->isLost()) analysis.stop();
+    else analysis.start(game->position(), positionHistory);
 }
 
 void CheckersGame::run() {
     while (window.isOpen()) {
-        handleEvents();
-        render();
-    }
-}
+        {
+            PROFILE_ZONE("frame");
+            if (analysisMode && analysis.poll(analysisInfo)) dirty = true;
+            ComputerMove reply;
+            if (computerThinking && moveWorker.poll(reply)) finishComputerMove(reply);
+            if (dirty) render();
+        }
 
-void CheckersGame::handleEvents() {
-    sf::Event event;
-    while (window.pollEvent(event)) {
-        if (event.type == sf::Event::Closed) {
-            window.close();
+        // Without a move (a finished game reached by redo) the computer
+        // waits like a human until the position or the players change.
+        if (isComputerTurn() && !computerStalled && !computerThinking) {
+            startComputerMove();
+            continue;
         }
 
-        if (event.type == sf::Event::MouseButtonPressed && event.mouseButton.button == sf::Mouse::Left) {
+        sf::Event event;
+        if (analysisMode || computerThinking) {
+            // Results come in from the workers, so poll at the frame rate.
+            while (window.isOpen() && window.pollEvent(event)) handleEvent(event);
+            if (!dirty) sf::sleep(sf::milliseconds(FRAME_MS));
+            continue;
+        }
+
+        // Sleep until something happens instead of redrawing every frame.
+        if (!window.waitEvent(event)) continue;
+        do {
+            handleEvent(event);
+        } while (window.isOpen() && window.pollEvent(event));
+    }
+}
+
+void CheckersGame::handleEvent(const sf::Event& event) {
+    PROFILE_ZONE("handleEvent");
+    switch (event.type) {
+    case sf::Event::Closed:
+        window.close();
+        break;
+    case sf::Event::Resized:
+    case sf::Event::GainedFocus:
+        dirty = true;
+        break;
+    case sf::Event::MouseButtonPressed:
+        if (event.mouseButton.button == sf::Mouse::Left) {
             handleMouseClick(event.mouseButton.x, event.mouseButton.y);
         }
+        break;
+    case sf::Event::KeyPressed:
+        if (event.key.control && event.key.code == sf::Keyboard::Z) {
+            undoMove();
+        } else if (event.key.control && event.key.code == sf::Keyboard::Y) {
+            redoMove();
+        } else if (event.key.code == sf::Keyboard::A) {
+            toggleAnalysis();
+        } else if (event.key.code == sf::Keyboard::F1) {
+            setPlayer(PieceColor::White, nextPlayerType(whitePlayer));
+        } else if (event.key.code == sf::Keyboard::F2) {
+            setPlayer(PieceColor::Black, nextPlayerType(blackPlayer));
+        }
+        break;
+    default:
+        break;
     }
 }
 
 void CheckersGame::handleMouseClick(int x, int y) {
-    int col = x / CELL_SIZE;
-    int row = y / CELL_SIZE;
+    int col = static_cast<int>(x / cellSize);
+    int row = static_cast<int>(y / cellSize);
 
-    if (!isValidPosition(row, col)) return;
+    if (!isValidPosition(row, col) || isComputerTurn()) return;
 
-    checkForMandatoryCaptures();
-
-    if (board[row][col].color == currentPlayer) {
-        if (mustCapture && !canPieceCapture(row, col)) return;
+    int sq = variant->squareIndex(row, col);
+    if (captureStep == 0 && sq >= 0 && variant->pieceAt(sq).color == variant->sideToMove()) {
+        if (mustCapture && !(variant->capturers() & (uint64_t(1) << sq))) return;
 
         selectedPiecePos = {row, col};
-        board[row][col].selected = true;
         calculatePossibleMoves(row, col);
     } else if (isMoving && isPossibleMove(row, col)) {
         movePiece(selectedPiecePos.x, selectedPiecePos.y, row, col);
 
-        if (abs(selectedPiecePos.x - row) == 2 && canContinueCapturing(row, col)) {
+        if (captureStep > 0) {
             selectedPiecePos = {row, col};
-            board[row][col].selected = true;
             calculatePossibleMoves(row, col);
             return;
         }
 
-        currentPlayer = (currentPlayer == PieceColor::White) ? PieceColor::Black : PieceColor::White;
-        isMoving = mustCapture = false;
-        clearPossibleMoves();
-
-        if (checkWinCondition()) {
-            std::cout << (currentPlayer == PieceColor::White ? "Black" : "White") << " wins!" << std::endl;
-            window.close();
-        }
+        finishTurn();
     }
 }
 
-bool CheckersGame::isValidPosition(int row, int col) const {
-    return row >= 0 && row < BOARD_SIZE && col >= 0 && col < BOARD_SIZE;
+void CheckersGame::finishTurn() {
+    syncPosition();
+
+    if (checkWinCondition()) {
+        std::cout << (variant->sideToMove() == PieceColor::White ? "Black" : "White") << " wins!" << std::endl;
+        window.close();
+    }
 }
 
-void CheckersGame::checkDirection(int row, int col, int dr, int dc, bool checkCaptures) {
-    if (board[row][col].type == PieceType::Man) {
-        int forward_dir = (board[row][col].color == PieceColor::White) ? 1 : -1;
+bool CheckersGame::isComputerTurn() const {
+    if (!variant->engineGame()) return false;
+    return (variant->sideToMove() == PieceColor::White ? whitePlayer : blackPlayer) != PlayerType::Human;
+}
 
-        if (checkCaptures) {
-            int newRow = row + dr;
-            int newCol = col + dc;
-            int jumpRow = row + 2 * dr;
-            int jumpCol = col + 2 * dc;
+// Book moves are played at once; anything else is searched by the move
+// worker and played by finishComputerMove() when run() polls it.
+void CheckersGame::startComputerMove() {
+    PROFILE_ZONE("startComputerMove");
+    GameState& game = *variant->engineGame();
+    Move move;
+    if (openingBook.pickMove(game.position(), bookRandom(), move)) {
+        variant->makeMove(toVariantMove(move));
+        redoMoves.clear();
+        finishTurn();
+        return;
+    }
+    PlayerType player = game.sideToMove() == PieceColor::White ? whitePlayer : blackPlayer;
+    moveWorker.start(game.position(), positionHistory, player == PlayerType::Mcts, engineLimits);
+    computerThinking = true;
+    dirty = true;
+}
 
-            if (canCapture(row, col, newRow, newCol, jumpRow, jumpCol)) {
-                captureMoves.emplace_back(jumpRow, jumpCol);
-            }
-        } else {
-            if (dr != forward_dir) return;
+void CheckersGame::finishComputerMove(const ComputerMove& reply) {
+    computerThinking = false;
+    if (!reply.hasMove) {
+        computerStalled = true;
+        return;
+    }
+    if (reply.mcts) {
+        const MctsResult& result = reply.mctsResult;
+        double rate = result.seconds > 0 ? result.playouts / result.seconds : 0;
+        std::cout << "mcts: " << result.playouts << " playouts (" << static_cast<uint64_t>(rate) << "/s), tree "
+                  << result.treeNodes << " nodes, " << result.treeBytes / (1024 * 1024) << " of "
+                  << reply.mctsArenaBytes / (1024 * 1024) << " MB" << std::endl;
+    }
 
-            int newRow = row + dr;
-            int newCol = col + dc;
+    variant->makeMove(toVariantMove(reply.move));
+    redoMoves.clear();
+    finishTurn();
+}
 
-            if (isValidPosition(newRow, newCol) && board[newRow][newCol].color == PieceColor::None) {
-                possibleMoves.emplace_back(newRow, newCol);
-            }
-        }
-    } else {
-        int r = row + dr;
-        int c = col + dc;
-        bool foundEnemy = false;
-
-        while (isValidPosition(r, c)) {
-            if (board[r][c].color != PieceColor::None) {
-                if (board[r][c].color == currentPlayer) break;
-                if (!foundEnemy) {
-                    foundEnemy = true;
-                    int jumpR = r + dr;
-                    int jumpC = c + dc;
-
-                    while (isValidPosition(jumpR, jumpC) && board[jumpR][jumpC].color == PieceColor::None) {
-                        captureMoves.emplace_back(jumpR, jumpC);
-                        jumpR += dr;
-                        jumpC += dc;
-                    }
-                }
-                break;
-            }
-            if (!checkCaptures) possibleMoves.emplace_back(r, c);
-            r += dr;
-            c += dc;
-        }
-    }
+// The search unwinds on the worker; its move is never handed out.
+void CheckersGame::cancelComputerMove() {
+    if (!computerThinking) return;
+    moveWorker.stop();
+    computerThinking = false;
 }
 
-void CheckersGame::findKingCaptures(int row, int col, int dr, int dc) {
-    int r = row + dr;
-    int c = col + dc;
-    bool foundEnemy = false;
-
-    while (isValidPosition(r, c)) {
-        if (board[r][c].color != PieceColor::None) {
-            if (board[r][c].color == currentPlayer) break;
-            if (!foundEnemy) {
-                foundEnemy = true;
-                int jumpR = r + dr;
-                int jumpC = c + dc;
-
-                while (isValidPosition(jumpR, jumpC) && board[jumpR][jumpC].color == PieceColor::None) {
-                    captureMoves.emplace_back(jumpR, jumpC);
-                    jumpR += dr;
-                    jumpC += dc;
-                }
-            }
-            break;
-        }
-        r += dr;
-        c += dc;
-    }
+// Undo and redo step over the computer's replies so the human is to move
+// afterwards, unless the other end of the game is reached first.
+void CheckersGame::undoMove() {
+    if (variant->ply() == 0) return;
+    do {
+        redoMoves.push_back(variant->moveAt(variant->ply() - 1));
+        variant->unmakeMove();
+    } while (variant->ply() > 0 && isComputerTurn());
+    syncPosition();
 }
 
-void CheckersGame::checkForMandatoryCaptures() {
-    mustCapture = false;
-    for (int row = 0; row < BOARD_SIZE; ++row) {
-        for (int col = 0; col < BOARD_SIZE; ++col) {
-            if (board[row][col].color == currentPlayer && canPieceCapture(row, col)) {
-                mustCapture = true;
-                return;
-            }
-        }
-    }
+void CheckersGame::redoMove() {
+    if (redoMoves.empty()) return;
+    do {
+        variant->makeMove(redoMoves.back());
+        redoMoves.pop_back();
+    } while (!redoMoves.empty() && isComputerTurn());
+    syncPosition();
 }
 
-bool CheckersGame::canPieceCapture(int row, int col) {
-    if (board[row][col].type == PieceType::Man) {
-        for (int dr : {-1, 1}) {
-            for (int dc : {-1, 1}) {
-                if (canCapture(row, col, row + dr, col + dc, row + 2*dr, col + 2*dc)) {
-                    return true;
-                }
-            }
-        }
-    } else {
-        for (int dr : {-1, 1}) {
-            for (int dc : {-1, 1}) {
-                int r = row + dr;
-                int c = col + dc;
-                bool foundEnemy = false;
-
-                while (isValidPosition(r, c)) {
-                    if (board[r][c].color != PieceColor::None) {
-                        if (board[r][c].color == currentPlayer) break;
-                        if (!foundEnemy) {
-                            foundEnemy = true;
-                            int jumpR = r + dr;
-                            int jumpC = c + dc;
-                            if (isValidPosition(jumpR, jumpC) && board[jumpR][jumpC].color == PieceColor::None) {
-                                return true;
-                            }
-                        }
-                        break;
-                    }
-                    r += dr;
-                    c += dc;
-                }
-            }
-        }
-    }
-    return false;
+bool CheckersGame::isValidPosition(int row, int col) const {
+    return row >= 0 && row < boardSize && col >= 0 && col < boardSize;
 }
 
-bool CheckersGame::canCapture(int fromRow, int fromCol, int midRow, int midCol, int toRow, int toCol) {
-    return isValidPosition(toRow, toCol) &&
-           board[toRow][toCol].color == PieceColor::None &&
-           isValidPosition(midRow, midCol) &&
-           board[midRow][midCol].color != PieceColor::None &&
-           board[midRow][midCol].color != board[fromRow][fromCol].color;
+void CheckersGame::checkForMandatoryCaptures() {
+    PROFILE_ZONE("checkForMandatoryCaptures");
+    variant->generateMoves(legalMoves);
+    mustCapture = variant->capturers() != 0;
 }
 
 void CheckersGame::calculatePossibleMoves(int row, int col) {
-    possibleMoves.clear();
-    captureMoves.clear();
+    PROFILE_ZONE("calculatePossibleMoves");
+    possibleMoves = 0;
     isMoving = true;
+    dirty = true;
 
-    if (board[row][col].type == PieceType::Man) {
-        for (int dr : {-1, 1}) {
-            for (int dc : {-1, 1}) {
-                checkDirection(row, col, dr, dc, true);
-            }
-        }
-
-        int forward_dir = (board[row][col].color == PieceColor::White) ? 1 : -1;
-        for (int dc : {-1, 1}) {
-            checkDirection(row, col, forward_dir, dc, false);
-        }
-    } else {
-        for (int dr : {-1, 1}) {
-            for (int dc : {-1, 1}) {
-                findKingCaptures(row, col, dr, dc);
-                if (!mustCapture) checkDirection(row, col, dr, dc, false);
-            }
+    if (captureStep == 0) {
+        int sq = variant->squareIndex(row, col);
+        candidateMoves.clear();
+        for (const auto& move : legalMoves) {
+            if (move.from == sq) candidateMoves.push_back(move);
         }
     }
 
-    if (!captureMoves.empty()) possibleMoves = captureMoves;
-}
-
-bool CheckersGame::canContinueCapturing(int row, int col) {
-    if (board[row][col].type == PieceType::Man) {
-        for (int dr : {-1, 1}) {
-            for (int dc : {-1, 1}) {
-                if (canCapture(row, col, row + dr, col + dc, row + 2*dr, col + 2*dc)) {
-                    return true;
-                }
-            }
-        }
-    } else {
-        for (int dr : {-1, 1}) {
-            for (int dc : {-1, 1}) {
-                int r = row + dr;
-                int c = col + dc;
-                bool foundEnemy = false;
-
-                while (isValidPosition(r, c)) {
-                    if (board[r][c].color != PieceColor::None) {
-                        if (board[r][c].color == currentPlayer) break;
-                        if (!foundEnemy) {
-                            foundEnemy = true;
-                            int jumpR = r + dr;
-                            int jumpC = c + dc;
-                            if (isValidPosition(jumpR, jumpC) && board[jumpR][jumpC].color == PieceColor::None) {
-                                return true;
-                            }
-                        }
-                        break;
-                    }
-                    r += dr;
-                    c += dc;
-                }
-            }
-        }
+    for (const auto& move : candidateMoves) {
+        possibleMoves |= uint64_t(1) << move.path[captureStep];
     }
-    return false;
 }
 
 bool CheckersGame::isPossibleMove(int row, int col) {
-    for (const auto& pos : possibleMoves) {
-        if (pos.x == row && pos.y == col) {
-            return true;
-        }
-    }
-    return false;
+    int sq = variant->squareIndex(row, col);
+    return sq >= 0 && (possibleMoves & (uint64_t(1) << sq));
 }
 
 void CheckersGame::movePiece(int fromRow, int fromCol, int toRow, int toCol) {
-    board[toRow][toCol] = board[fromRow][fromCol];
-    board[fromRow][fromCol] = {PieceType::None, PieceColor::None};
-    board[toRow][toCol].selected = false;
-
-    if (board[toRow][toCol].type == PieceType::Man) {
-        if ((board[toRow][toCol].color == PieceColor::White && toRow == BOARD_SIZE - 1) ||
-            (board[toRow][toCol].color == PieceColor::Black && toRow == 0)) {
-            board[toRow][toCol].type = PieceType::King;
+    int from = variant->squareIndex(fromRow, fromCol);
+    int to = variant->squareIndex(toRow, toCol);
+
+    std::vector<VariantMove> remaining;
+    for (const auto& move : candidateMoves) {
+        if (move.path[captureStep] == to) remaining.push_back(move);
+    }
+    candidateMoves = remaining;
+    ++captureStep;
+    dirty = true;
+
+    for (const auto& move : candidateMoves) {
+        if (move.pathLength == captureStep) {
+            variant->makeMove(move);
+            redoMoves.clear();
+            captureStep = 0;
+            return;
         }
     }
 
-    if (abs(fromRow - toRow) == 2) {
-        int midRow = (fromRow + toRow) / 2;
-        int midCol = (fromCol + toCol) / 2;
-        board[midRow][midCol] = {PieceType::None, PieceColor::None};
-    }
+    // Mid-sequence: show the piece on its landing square, captured pieces
+    // stay on the board until the whole sequence is played. Crowning is left
+    // to the finished move since the variants disagree on when it happens.
+    displayBoard[to] = displayBoard[from];
+    displayBoard[from] = Piece();
 }
 
 bool CheckersGame::checkWinCondition() {
-    bool whiteExists = false;
-    bool blackExists = false;
-
-    for (const auto& row : board) {
-        for (const auto& piece : row) {
-            if (piece.color == PieceColor::White) whiteExists = true;
-            if (piece.color == PieceColor::Black) blackExists = true;
-            if (whiteExists && blackExists) return false;
-        }
-    }
-    return true;
+    return legalMoves.empty();
+}
+
+sf::Vector2f CheckersGame::squareCenter(int sq) const {
+    return sf::Vector2f((variant->squareCol(sq) + 0.5f) * cellSize, (variant->squareRow(sq) + 0.5f) * cellSize);
 }
 
 void CheckersGame::clearPossibleMoves() {
-    possibleMoves.clear();
-    captureMoves.clear();
-    for (auto& row : board) {
-        for (auto& piece : row) {
-            piece.selected = false;
-        }
-    }
+    possibleMoves = 0;
+    candidateMoves.clear();
+    captureStep = 0;
     selectedPiecePos = {-1, -1};
+    dirty = true;
 }
 
-void CheckersGame::render() {
-    window.clear();
-
-    for (int row = 0; row < BOARD_SIZE; ++row) {
-        for (int col = 0; col < BOARD_SIZE; ++col) {
-            sf::RectangleShape cell(sf::Vector2f(CELL_SIZE, CELL_SIZE));
-            cell.setPosition(col * CELL_SIZE, row * CELL_SIZE);
-            cell.setFillColor((row + col) % 2 == 0 ? sf::Color(210, 180, 140) : sf::Color(139, 69, 19));
-            window.draw(cell);
+void CheckersGame::buildBoard() {
+    boardVertices.clear();
+    for (int row = 0; row < boardSize; ++row) {
+        for (int col = 0; col < boardSize; ++col) {
+            appendQuad(boardVertices, sf::Vector2f(col * cellSize, row * cellSize),
+                       sf::Vector2f(cellSize, cellSize), (row + col) % 2 == 0 ? LIGHT_CELL : DARK_CELL);
         }
     }
+}
+
+void CheckersGame::buildOverlay() {
+    overlayVertices.clear();
 
-    for (const auto& pos : possibleMoves) {
-        sf::RectangleShape highlight(sf::Vector2f(CELL_SIZE - 10, CELL_SIZE - 10));
-        highlight.setPosition(pos.y * CELL_SIZE + 5, pos.x * CELL_SIZE + 5);
-        highlight.setFillColor(sf::Color(0, 255, 0, 100));
-        window.draw(highlight);
+    float inset = HIGHLIGHT_INSET * cellSize;
+    uint64_t targets = possibleMoves;
+    while (targets) {
+        int sq = popLowest(targets);
+        appendQuad(overlayVertices,
+                   sf::Vector2f(variant->squareCol(sq) * cellSize + inset, variant->squareRow(sq) * cellSize + inset),
+                   sf::Vector2f(cellSize - 2 * inset, cellSize - 2 * inset), HIGHLIGHT);
     }
 
-    for (int row = 0; row < BOARD_SIZE; ++row) {
-        for (int col = 0; col < BOARD_SIZE; ++col) {
-            if (board[row][col].color != PieceColor::None) {
-                sf::Vector2f position(col * CELL_SIZE + CELL_SIZE / 2,
-                                    row * CELL_SIZE + CELL_SIZE / 2);
-
-                if (board[row][col].type == PieceType::Man) {
-                    pieceShape.setPosition(position.x - pieceShape.getRadius(),
-                                        position.y - pieceShape.getRadius());
-                    pieceShape.setFillColor(board[row][col].color == PieceColor::White ?
-                                        sf::Color::White : sf::Color(150, 0, 0));
-                    window.draw(pieceShape);
-                } else {
-                    kingShape.setPosition(position.x - kingShape.getRadius(),
-                                        position.y - kingShape.getRadius());
-                    kingShape.setFillColor(board[row][col].color == PieceColor::White ?
-                                        sf::Color::White : sf::Color(150, 0, 0));
-                    window.draw(kingShape);
-                }
-
-                if (board[row][col].selected) {
-                    sf::CircleShape selection(CELL_SIZE / 2 - 5);
-                    selection.setPosition(col * CELL_SIZE + 5, row * CELL_SIZE + 5);
-                    selection.setFillColor(sf::Color::Transparent);
-                    selection.setOutlineThickness(3);
-                    selection.setOutlineColor(sf::Color::Yellow);
-                    window.draw(selection);
-                }
-            }
+    float pieceRadius = PIECE_RADIUS * cellSize;
+    float selectionRadius = SELECTION_RADIUS * cellSize;
+    for (int sq = 0; sq < static_cast<int>(displayBoard.size()); ++sq) {
+        Piece piece = displayBoard[sq];
+        if (piece.color == PieceColor::None) continue;
+
+        int row = variant->squareRow(sq);
+        int col = variant->squareCol(sq);
+        sf::Vector2f center = squareCenter(sq);
+        int points = piece.type == PieceType::King ? KING_POINTS : CIRCLE_POINTS;
+        sf::Color fill = piece.color == PieceColor::White ? sf::Color::White : BLACK_PIECE;
+
+        appendPolygon(overlayVertices, center, pieceRadius + PIECE_OUTLINE, points, sf::Color::Black);
+        appendPolygon(overlayVertices, center, pieceRadius, points, fill);
+
+        if (selectedPiecePos.x == row && selectedPiecePos.y == col) {
+            appendRing(overlayVertices, center, selectionRadius, selectionRadius + SELECTION_OUTLINE,
+                       CIRCLE_POINTS, sf::Color::Yellow);
         }
     }
+}
 
-    sf::Text text;
-    text.setFont(font);
-    text.setString("Текущий игрок: " + std::string(currentPlayer == PieceColor::White ? "Белые" : "Черные"));
-    text.setCharacterSize(24);
-    text.setFillColor(sf::Color::Black);
-    text.setPosition(10, 10);
-    window.draw(text);
+// Arrows for the first two moves of the principal variation, drawn over the
+// pieces; only while the line belongs to the position on the board.
+void CheckersGame::appendAnalysisLine() {
+    if (!analysisMode || isMoving || captureStep > 0) return;
+    for (size_t i = 0; i < analysisInfo.pv.size() && i < 2; ++i) {
+        const Move& move = analysisInfo.pv[i];
+        sf::Color color = i == 0 ? BEST_MOVE : REPLY_MOVE;
+        sf::Vector2f from = squareCenter(move.from);
+        for (int step = 0; step < move.pathLength; ++step) {
+            sf::Vector2f to = squareCenter(move.path[step]);
+            appendSegment(overlayVertices, from, to, ANALYSIS_WIDTH, color);
+            from = to;
+        }
+        appendPolygon(overlayVertices, from, ANALYSIS_WIDTH, CIRCLE_POINTS, color);
+    }
+}
 
+std::string CheckersGame::analysisSummary() const {
+    if (!analysisMode) return "";
+    if (analysisInfo.depth == 0) return analysisInfo.searching ? "Анализ..." : "";
+
+    // Shown from White's side, in men.
+    int score = variant->sideToMove() == PieceColor::White ? analysisInfo.score : -analysisInfo.score;
+    char head[96];
+    if (std::abs(score) > MATE_BOUND) {
+        std::snprintf(head, sizeof(head), "Глубина %d, %s через %d", analysisInfo.depth,
+                      score > 0 ? "белые выигрывают" : "черные выигрывают", MATE_SCORE - std::abs(score));
+    } else {
+        std::snprintf(head, sizeof(head), "Глубина %d, оценка %+.2f", analysisInfo.depth, score / 100.0);
+    }
+    std::string text = head;
+    for (size_t i = 0; i < analysisInfo.pv.size() && i < ANALYSIS_PV_MOVES; ++i) {
+        text += " " + moveToString(analysisInfo.pv[i]);
+    }
+    return text;
+}
+
+void CheckersGame::render() {
+    PROFILE_ZONE("render");
+    renderTo(window);
     window.display();
+    dirty = false;
+}
+
+void CheckersGame::renderTo(sf::RenderTarget& target) {
+    buildOverlay();
+    appendAnalysisLine();
+    analysisText.setString(analysisSummary());
+    bool white = variant->sideToMove() == PieceColor::White;
+    const char* player = !isComputerTurn() ? ""
+                         : (white ? whitePlayer : blackPlayer) == PlayerType::Mcts ? " (компьютер, MCTS)"
+                                                                                    : " (компьютер)";
+    statusText.setString("Текущий игрок: " + std::string(white ? "Белые" : "Черные") + player);
+
+    target.clear();
+    target.draw(boardVertices);
+    target.draw(overlayVertices);
+    target.draw(statusText);
+    if (analysisMode) target.draw(analysisText);
 }
@@ -5,54 +5,102 @@
 #include <vector>
 #include <iostream>
 #include <algorithm>
+#include <memory>
+#include <random>
+#include <string>
 
-const int WINDOW_SIZE = 800;
-const int BOARD_SIZE = 8;
-const int CELL_SIZE = WINDOW_SIZE / BOARD_SIZE;
+#include "analysis.h"
+#include "bitboard.h"
+#include "game_state.h"
+#include "mcts.h"
+#include "opening_book.h"
+#include "search.h"
+#include "variant.h"
 
-enum class PieceType { None, Man, King };
-enum class PieceColor { None, White, Black };
+const int WINDOW_SIZE = 800;
 
-struct Piece {
-    PieceType type = PieceType::None;
-    PieceColor color = PieceColor::None;
-    bool selected = false;
-};
+// Computer is the alpha-beta engine, Mcts the Monte Carlo tree search.
+enum class PlayerType { Human, Computer, Mcts };
 
 class CheckersGame {
 private:
     sf::RenderWindow window;
-    std::vector<std::vector<Piece>> board;
-    PieceColor currentPlayer = PieceColor::White;
+    // The rules are picked at startup; the engine side only exists for
+    // variants whose engineGame() is not null.
+    std::unique_ptr<Variant> variant;
+    int boardSize;
+    float cellSize;
+    std::vector<Piece> displayBoard;
     bool isMoving = false;
     sf::Vector2i selectedPiecePos = {-1, -1};
-    std::vector<sf::Vector2i> possibleMoves;
-    std::vector<sf::Vector2i> captureMoves;
+    uint64_t possibleMoves = 0;     // landing squares for the next click
+    std::vector<VariantMove> legalMoves;
+    std::vector<VariantMove> candidateMoves;    // legal moves matching the clicks so far
+    int captureStep = 0;
     bool mustCapture = false;
 
-    sf::CircleShape pieceShape;
-    sf::CircleShape kingShape;
+    PlayerType whitePlayer = PlayerType::Human;
+    PlayerType blackPlayer = PlayerType::Human;
+    // The computer's moves are searched off the UI thread as well.
+    MoveWorker moveWorker;
+    SearchLimits engineLimits;
+    bool computerThinking = false;
+    OpeningBook openingBook;
+    std::mt19937_64 bookRandom{std::random_device{}()};
+    std::vector<uint64_t> positionHistory;
+    std::vector<VariantMove> redoMoves;
+    bool computerStalled = false;   // the engine found no move here
+
+    // Analysis mode searches the position on the human's turn in the
+    // background and draws the best line as it deepens.
+    AnalysisWorker analysis;
+    AnalysisInfo analysisInfo;
+    bool analysisMode = false;
+
+    // The board never changes and is built once; highlights, pieces and the
+    // selection ring are batched into one array rebuilt only when `dirty`.
+    sf::VertexArray boardVertices;
+    sf::VertexArray overlayVertices;
     sf::Font font;
+    sf::Text statusText;
+    sf::Text analysisText;
+    bool dirty = true;
 
     bool isValidPosition(int row, int col) const;
-    void checkDirection(int row, int col, int dr, int dc, bool checkCaptures);
-    void findKingCaptures(int row, int col, int dr, int dc);
-    bool canCapture(int fromRow, int fromCol, int midRow, int midCol, int toRow, int toCol);
-    bool canPieceCapture(int row, int col);
     void checkForMandatoryCaptures();
     void calculatePossibleMoves(int row, int col);
     bool isPossibleMove(int row, int col);
     void movePiece(int fromRow, int fromCol, int toRow, int toCol);
-    bool canContinueCapturing(int row, int col);
     bool checkWinCondition();
+    sf::Vector2f squareCenter(int sq) const;
     void clearPossibleMoves();
     void handleMouseClick(int x, int y);
+    void finishTurn();
+    bool isComputerTurn() const;
+    void startComputerMove();
+    void finishComputerMove(const ComputerMove& reply);
+    void cancelComputerMove();
+    void undoMove();
+    void redoMove();
+    void syncPosition();
+    void toggleAnalysis();
+    void restartAnalysis();
+    void appendAnalysisLine();
+    std::string analysisSummary() const;
+    void buildBoard();
+    void buildOverlay();
 
 public:
-    CheckersGame();
+    // Falls back to Russian draughts for an unknown variant name. Without a
+    // window the game only renders through renderTo(), e.g. for benchmarks.
+    explicit CheckersGame(const std::string& variantName = "russian", bool openWindow = true);
+    void setPlayer(PieceColor color, PlayerType type);
+    void setEngineOptions(int moveTimeMs, size_t hashMegabytes, int threads);
+    bool setOpeningBook(const std::string& path);
     void run();
-    void handleEvents();
+    void handleEvent(const sf::Event& event);
     void render();
+    void renderTo(sf::RenderTarget& target);
     void initializeBoard();
 };
 
@@ -0,0 +1,484 @@
+#include "dfpn.h"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <thread>
+
+#include "notation.h"
+#include "profiler.h"
+#include "tablebase.h"
+#include "zobrist.h"
+
+namespace {
+
+// Proof and disproof numbers saturate here; INF stands for "cannot be done".
+const uint32_t INF = 1u << 30;
+// Child thresholds get (1 + EPSILON) times the second best instead of one
+// more than it, so the search switches branches far less often.
+const double EPSILON = 0.25;
+const int BUCKET_SIZE = 5;
+const int BUSY_SLOTS = 1 << 16;
+const int NODE_BATCH = 1024;
+
+// The attacker is the side to move at the root. Inside the search a node's
+// numbers are (phi, delta), the proof and disproof numbers of "the side to
+// move here gets what it wants": a win for the attacker, anything else for
+// the defender.
+void setPnDn(uint32_t pn, uint32_t dn, bool attacker, uint32_t& phi, uint32_t& delta) {
+    phi = attacker ? pn : dn;
+    delta = attacker ? dn : pn;
+}
+
+bool sameMove(const Move& a, const Move& b) {
+    return a.from == b.from && a.to == b.to && a.captured == b.captured;
+}
+
+bool checkNode(const Position& pos, const ProofNode& node, int remaining, bool attacker) {
+    if (node.tablebase) return node.children.empty();
+    // On the heap, like everything that recurses once per ply here.
+    std::unique_ptr<MoveList> list(new MoveList);
+    const MoveList& moves = *list;
+    generateMoves(pos, *list);
+    if (moves.empty()) return !attacker && node.children.empty();
+    if (remaining == 0) return false;
+    if (node.children.size() != (attacker ? 1 : moves.size())) return false;
+
+    for (const auto& child : node.children) {
+        bool legal = false;
+        for (const auto& move : moves) legal = legal || sameMove(move, child.move);
+        if (!legal) return false;
+        // Distinct legal replies, as many as there are moves, cover them all.
+        for (const auto& other : node.children) {
+            if (&other != &child && sameMove(other.move, child.move)) return false;
+        }
+        Position next = pos;
+        makeMove(next, child.move);
+        if (!checkNode(next, child, remaining - 1, !attacker)) return false;
+    }
+    return true;
+}
+
+} // namespace
+
+struct DfpnSolver::Entry {
+    uint64_t key = 0;
+    uint32_t pn = 0;
+    uint32_t dn = 0;
+    uint32_t work = 0;      // nodes spent on it, 0 for an empty slot
+    int16_t depth = 0;      // remaining plies it was computed for
+};
+
+struct alignas(64) DfpnSolver::Bucket {
+    std::atomic<bool> locked{false};
+    Entry entries[BUCKET_SIZE];
+};
+
+struct DfpnSolver::Child {
+    Move move;
+    Position pos;
+    uint64_t key = 0;
+    uint32_t phi = 1;
+    uint32_t delta = 1;
+};
+
+// Left uninitialized like BasicMoveList: only the first `count` are used.
+union DfpnSolver::ChildArray {
+    ChildArray() {}
+    Child items[MAX_MOVES];
+};
+
+// The moves and children of one mid() level. Every thread gets one per ply
+// on the heap, indexed by the plies remaining, since a deep horizon would
+// not fit them on a thread's stack.
+struct DfpnSolver::Frame {
+    MoveList moves;
+    ChildArray children;
+};
+
+namespace {
+
+class BucketLock {
+public:
+    explicit BucketLock(std::atomic<bool>& flag) : flag(flag) {
+        while (flag.exchange(true, std::memory_order_acquire)) std::this_thread::yield();
+    }
+    ~BucketLock() { flag.store(false, std::memory_order_release); }
+
+private:
+    std::atomic<bool>& flag;
+};
+
+} // namespace
+
+DfpnSolver::DfpnSolver(size_t tableMegabytes, int threads) : busy(new std::atomic<uint8_t>[BUSY_SLOTS]) {
+    for (int i = 0; i < BUSY_SLOTS; ++i) busy[i].store(0, std::memory_order_relaxed);
+    setTableSize(tableMegabytes);
+    setThreads(threads);
+}
+
+DfpnSolver::~DfpnSolver() = default;
+
+void DfpnSolver::setTableSize(size_t megabytes) {
+    if (megabytes == 0) megabytes = 1;
+    size_t count = 1;
+    while (count * 2 * sizeof(Bucket) <= megabytes * 1024 * 1024) count *= 2;
+    buckets.reset(new Bucket[count]);
+    bucketCount = count;
+}
+
+// A proof holds for any horizon at least as long as the one it was found
+// with, a disproof for any shorter one; open numbers only for the same.
+bool DfpnSolver::lookup(uint64_t key, int remaining, uint32_t& pn, uint32_t& dn) {
+    Bucket& bucket = buckets[key & (bucketCount - 1)];
+    BucketLock lock(bucket.locked);
+    bool found = false;
+    for (const Entry& entry : bucket.entries) {
+        if (entry.work == 0 || entry.key != key) continue;
+        if (entry.pn == 0 && entry.depth <= remaining) {
+            pn = 0;
+            dn = INF;
+            return true;
+        }
+        if (entry.dn == 0 && entry.depth >= remaining) {
+            pn = INF;
+            dn = 0;
+            return true;
+        }
+        if (entry.depth == remaining && entry.pn != 0 && entry.dn != 0) {
+            pn = entry.pn;
+            dn = entry.dn;
+            found = true;
+        }
+    }
+    return found;
+}
+
+void DfpnSolver::store(uint64_t key, int remaining, uint32_t pn, uint32_t dn, uint64_t work) {
+    Bucket& bucket = buckets[key & (bucketCount - 1)];
+    BucketLock lock(bucket.locked);
+    Entry* slot = nullptr;
+    for (Entry& entry : bucket.entries) {
+        if (entry.work != 0 && entry.key == key && entry.depth == remaining) {
+            slot = &entry;
+            work += entry.work;
+            break;
+        }
+    }
+    if (!slot) {
+        // Small-tree replacement: the cheapest entry to recompute goes.
+        slot = &bucket.entries[0];
+        for (Entry& entry : bucket.entries) {
+            if (entry.work < slot->work) slot = &entry;
+        }
+    }
+    slot->key = key;
+    slot->pn = pn;
+    slot->dn = dn;
+    slot->work = static_cast<uint32_t>(std::min<uint64_t>(std::max<uint64_t>(work, 1), UINT32_MAX));
+    slot->depth = static_cast<int16_t>(remaining);
+}
+
+// Numbers for a child about to be searched with `remaining` plies left and
+// `attacker` to move: the table, then game over, tablebase and horizon.
+void DfpnSolver::childValues(Child& child, int remaining, bool attacker) {
+    uint32_t pn;
+    uint32_t dn;
+    if (lookup(child.key, remaining, pn, dn)) {
+        setPnDn(pn, dn, attacker, child.phi, child.delta);
+        return;
+    }
+
+    // No legal move loses, whoever is to move.
+    if (capturers(child.pos) == 0 && movers(child.pos) == 0) {
+        child.phi = INF;
+        child.delta = 0;
+        return;
+    }
+
+    TablebaseResult tb;
+    if (tablebase && tablebase->probe(child.pos, tb) && tb.value != TB_UNKNOWN) {
+        bool attackerWins = tb.value == (attacker ? TB_WIN : TB_LOSS);
+        bool inReach = tb.distance == 0 || tb.distance <= remaining;
+        if (attackerWins && inReach) setPnDn(0, INF, attacker, child.phi, child.delta);
+        else setPnDn(INF, 0, attacker, child.phi, child.delta);
+        return;
+    }
+
+    if (remaining == 0) setPnDn(INF, 0, attacker, child.phi, child.delta);
+    else child.phi = child.delta = 1;
+}
+
+void DfpnSolver::countNode(uint64_t& nodes) {
+    if ((++nodes & (NODE_BATCH - 1)) != 0) return;
+    uint64_t total = totalNodes.fetch_add(NODE_BATCH, std::memory_order_relaxed) + NODE_BATCH;
+    bool limitHit = stopRequested.load(std::memory_order_relaxed) ||
+                    (limits.cancel && limits.cancel->load(std::memory_order_relaxed)) ||
+                    (limits.nodes && total >= limits.nodes);
+    if (!limitHit && limits.moveTimeMs > 0) {
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - startTime;
+        limitHit = elapsed.count() >= limits.moveTimeMs;
+    }
+    if (limitHit) stopFlag = true;
+}
+
+// Multiple iterative deepening at one node: keeps searching the most
+// promising child until the node's numbers reach the thresholds. Only called
+// on nodes with a move and at least one ply left.
+void DfpnSolver::mid(const Position& pos, uint64_t key, int remaining, bool attacker, uint32_t thPhi, uint32_t thDelta,
+                     uint32_t& phi, uint32_t& delta, Frame* frames, uint64_t& nodes) {
+    uint64_t startNodes = nodes;
+    countNode(nodes);
+
+    MoveList& moves = frames[remaining].moves;
+    generateMoves(pos, moves);
+    int count = static_cast<int>(moves.size());
+    Child* children = frames[remaining].children.items;
+    for (int i = 0; i < count; ++i) {
+        Child& child = children[i];
+        child.move = moves[i];
+        child.pos = pos;
+        makeMove(child.pos, moves[i]);
+        child.key = hashPosition(child.pos);
+        childValues(child, remaining - 1, !attacker);
+    }
+
+    std::atomic<uint8_t>& busySlot = busy[key & (BUSY_SLOTS - 1)];
+    busySlot.fetch_add(1, std::memory_order_relaxed);
+    while (true) {
+        // A child another thread is searching looks proportionally harder,
+        // which sends this thread elsewhere; solved values are never touched.
+        uint64_t best = UINT64_MAX;
+        uint64_t second = INF;
+        uint64_t sumPhi = 0;
+        int bestIndex = 0;
+        for (int i = 0; i < count; ++i) {
+            Child& child = children[i];
+            uint32_t pn;
+            uint32_t dn;
+            if (lookup(child.key, remaining - 1, pn, dn)) setPnDn(pn, dn, !attacker, child.phi, child.delta);
+
+            sumPhi = std::min<uint64_t>(INF, sumPhi + child.phi);
+            uint64_t effective = child.delta;
+            if (threads > 1 && effective > 0 && effective < INF) {
+                uint8_t others = busy[child.key & (BUSY_SLOTS - 1)].load(std::memory_order_relaxed);
+                effective = std::min<uint64_t>(INF - 1, effective * (1 + others));
+            }
+            if (effective < best) {
+                second = best;
+                best = effective;
+                bestIndex = i;
+            } else if (effective < second) {
+                second = effective;
+            }
+        }
+        second = std::min<uint64_t>(second, INF);
+        phi = static_cast<uint32_t>(best);
+        delta = static_cast<uint32_t>(sumPhi);
+        if (phi >= thPhi || delta >= thDelta || stopped()) break;
+
+        Child& child = children[bestIndex];
+        uint32_t childThPhi = static_cast<uint32_t>(std::min<uint64_t>(INF, uint64_t(thDelta) - delta + child.phi));
+        uint64_t widened = second >= INF ? INF : std::max<uint64_t>(second + 1, std::ceil(second * (1 + EPSILON)));
+        uint32_t childThDelta = static_cast<uint32_t>(std::min<uint64_t>(thPhi, widened));
+        mid(child.pos, child.key, remaining - 1, !attacker, childThPhi, childThDelta, child.phi, child.delta, frames, nodes);
+    }
+    busySlot.fetch_sub(1, std::memory_order_relaxed);
+
+    uint32_t pn = attacker ? phi : delta;
+    uint32_t dn = attacker ? delta : phi;
+    store(key, remaining, pn, dn, nodes - startNodes);
+}
+
+// Searches a node until it is solved or a limit hits; true if proven.
+bool DfpnSolver::prove(const Position& pos, uint64_t key, int remaining, bool attacker, Frame* frames,
+                       uint64_t& nodes) {
+    uint32_t phi = 1;
+    uint32_t delta = 1;
+    while (phi != 0 && delta != 0 && !stopped()) {
+        mid(pos, key, remaining, attacker, INF, INF, phi, delta, frames, nodes);
+    }
+    return (attacker ? phi : delta) == 0;
+}
+
+// Rebuilds the proof below a proven node from the table, proving again what
+// replacement has thrown away.
+ProofTreeStatus DfpnSolver::extract(const Position& pos, uint64_t key, int remaining, bool attacker,
+                                    ProofNode& node, size_t& budget, Frame* frames, uint64_t& nodes) {
+    if (stopped()) return ProofTreeStatus::Stopped;
+    if (budget == 0) return ProofTreeStatus::BudgetExhausted;
+    --budget;
+
+    std::unique_ptr<MoveList> list(new MoveList);
+    const MoveList& moves = *list;
+    generateMoves(pos, *list);
+    if (moves.empty()) return attacker ? ProofTreeStatus::Failed : ProofTreeStatus::Complete;
+
+    TablebaseResult tb;
+    if (tablebase && tablebase->probe(pos, tb) && tb.value == (attacker ? TB_WIN : TB_LOSS) &&
+        (tb.distance == 0 || tb.distance <= remaining)) {
+        node.tablebase = true;
+        return ProofTreeStatus::Complete;
+    }
+    if (remaining == 0) return ProofTreeStatus::Failed;
+
+    for (int attempt = 0; attempt < 2; ++attempt) {
+        for (const auto& move : moves) {
+            Child child;
+            child.move = move;
+            child.pos = pos;
+            makeMove(child.pos, move);
+            child.key = hashPosition(child.pos);
+            childValues(child, remaining - 1, !attacker);
+
+            // The child's proof number is its delta at a defender node.
+            bool proven = (attacker ? child.delta : child.phi) == 0;
+            if (!proven && !attacker) proven = prove(child.pos, child.key, remaining - 1, !attacker, frames, nodes);
+            if (!proven) {
+                if (attacker) continue;
+                return stopped() ? ProofTreeStatus::Stopped : ProofTreeStatus::Failed;
+            }
+
+            ProofNode next;
+            next.move = move;
+            ProofTreeStatus status = extract(child.pos, child.key, remaining - 1, !attacker, next, budget, frames, nodes);
+            node.children.push_back(std::move(next));
+            if (status != ProofTreeStatus::Complete) return status;
+            if (attacker) return status;
+        }
+        if (!attacker) return ProofTreeStatus::Complete;
+        // No winning child left in the table: prove this node again.
+        if (attempt == 0 && !prove(pos, key, remaining, true, frames, nodes)) break;
+    }
+    return stopped() ? ProofTreeStatus::Stopped : ProofTreeStatus::Failed;
+}
+
+SolveResult DfpnSolver::solve(const Position& pos, const SearchLimits& searchLimits, size_t maxTreeNodes) {
+    PROFILE_ZONE("DfpnSolver::solve");
+    limits = searchLimits;
+    startTime = std::chrono::steady_clock::now();
+    stopRequested = false;
+    stopFlag = false;
+    totalNodes = 0;
+    // Entries depend on which side is attacking, so nothing carries over.
+    for (size_t i = 0; i < bucketCount; ++i) {
+        for (Entry& entry : buckets[i].entries) entry = Entry();
+    }
+
+    SolveResult result;
+    result.plies = std::max(0, std::min(limits.depth, MAX_PLY));
+    MoveList rootMoves;
+    generateMoves(pos, rootMoves);
+    if (rootMoves.empty() || result.plies == 0) {
+        result.outcome = SolveOutcome::NoWin;
+        return result;
+    }
+
+    uint64_t key = hashPosition(pos);
+    auto run = [this, &pos, key, &result]() {
+        std::unique_ptr<Frame[]> frames(new Frame[result.plies + 1]);
+        uint64_t nodes = 0;
+        prove(pos, key, result.plies, true, frames.get(), nodes);
+        stopFlag = true;
+        totalNodes.fetch_add(nodes & (NODE_BATCH - 1), std::memory_order_relaxed);
+    };
+    std::vector<std::thread> helpers;
+    for (int i = 1; i < threads; ++i) helpers.emplace_back(run);
+    run();
+    for (auto& helper : helpers) helper.join();
+
+    uint32_t pn = 1;
+    uint32_t dn = 1;
+    lookup(key, result.plies, pn, dn);
+    result.proofNumber = pn;
+    result.disproofNumber = dn;
+    if (pn == 0) result.outcome = SolveOutcome::Win;
+    else if (dn == 0) result.outcome = SolveOutcome::NoWin;
+
+    if (result.outcome == SolveOutcome::Win) {
+        // Only cancellation may cut the extraction short.
+        const std::atomic<bool>* cancel = limits.cancel;
+        limits = SearchLimits();
+        limits.cancel = cancel;
+        stopFlag = stopRequested.load() || (cancel && cancel->load());
+        std::unique_ptr<Frame[]> frames(new Frame[result.plies + 1]);
+        uint64_t nodes = 0;
+        size_t budget = maxTreeNodes;
+        result.treeStatus = extract(pos, key, result.plies, true, result.tree, budget, frames.get(), nodes);
+        totalNodes.fetch_add(nodes & (NODE_BATCH - 1), std::memory_order_relaxed);
+    }
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - startTime;
+    result.seconds = elapsed.count();
+    result.nodes = totalNodes;
+    PROFILE_COUNTER("dfpn nodes", static_cast<int64_t>(result.nodes));
+    return result;
+}
+
+namespace {
+
+class TreeWriter {
+public:
+    // Tokens are separated by a space or a line break past 79 columns;
+    // a glued token follows the previous one directly.
+    void token(const std::string& text, bool glued = false) {
+        if (!glued && lineLength > 0) {
+            if (lineLength + 1 + text.size() > 79) {
+                out += "\n";
+                lineLength = 0;
+            } else {
+                out += " ";
+                ++lineLength;
+            }
+        }
+        out += text;
+        lineLength += text.size();
+    }
+
+    std::string out;
+
+private:
+    size_t lineLength = 0;
+};
+
+std::string moveToken(const Move& move, int number, bool white, bool showNumber) {
+    if (white) return std::to_string(number) + ". " + moveToString(move);
+    if (showNumber) return std::to_string(number) + "... " + moveToString(move);
+    return moveToString(move);
+}
+
+// `choices` are the moves at one node: the first continues the line, the
+// rest become variations right after it.
+void appendLine(TreeWriter& writer, const std::vector<ProofNode>& choices, int number, bool white, bool showNumber) {
+    if (choices.empty()) return;
+    const ProofNode& main = choices[0];
+    writer.token(moveToken(main.move, number, white, showNumber));
+    if (main.tablebase) writer.token("{tablebase}");
+
+    for (size_t i = 1; i < choices.size(); ++i) {
+        writer.token("(" + moveToken(choices[i].move, number, white, true));
+        if (choices[i].tablebase) writer.token("{tablebase}");
+        appendLine(writer, choices[i].children, white ? number : number + 1, !white, false);
+        writer.token(")", true);
+    }
+    appendLine(writer, main.children, white ? number : number + 1, !white, choices.size() > 1);
+}
+
+} // namespace
+
+std::string formatProofTree(const Position& start, const ProofNode& tree) {
+    std::string result = start.sideToMove == PieceColor::White ? "2-0" : "0-2";
+    std::string out = "[GameType \"25\"]\n";
+    if (!(start == Position::initial())) out += "[FEN \"" + toFen(start) + "\"]\n";
+    out += "[Result \"" + result + "\"]\n\n";
+
+    TreeWriter writer;
+    if (tree.tablebase) writer.token("{tablebase}");
+    appendLine(writer, tree.children, 1, start.sideToMove == PieceColor::White, true);
+    writer.token(result);
+    return out + writer.out + "\n\n";
+}
+
+bool checkProofTree(const Position& start, const ProofNode& tree, int plies) {
+    return checkNode(start, tree, plies, true);
+}
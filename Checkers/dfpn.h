@@ -0,0 +1,108 @@
+#ifndef DFPN_H
+#define DFPN_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "bitboard.h"
+#include "search.h"
+
+class Tablebase;
+
+enum class SolveOutcome { Win, NoWin, Unknown };
+
+// How extracting the proof tree of a Win ended. Failed means a subtree that
+// replacement had thrown away could not be proven again.
+enum class ProofTreeStatus { Complete, BudgetExhausted, Stopped, Failed };
+
+// A solved line: `move` leads here (unset at the root). Below a node with
+// the attacker to move there is one winning move, below a defender node
+// every reply. Leaves are positions the defender cannot move in or that the
+// tablebase proves lost for the defender.
+struct ProofNode {
+    Move move;
+    bool tablebase = false;
+    std::vector<ProofNode> children;
+};
+
+struct SolveResult {
+    SolveOutcome outcome = SolveOutcome::Unknown;
+    int plies = 0;                  // horizon the answer holds for
+    uint32_t proofNumber = 0;       // of the root when Unknown
+    uint32_t disproofNumber = 0;
+    uint64_t nodes = 0;
+    double seconds = 0;
+    ProofNode tree;                 // only for Win
+    ProofTreeStatus treeStatus = ProofTreeStatus::Failed;
+};
+
+// Depth-first proof-number search for a forced win of the side to move
+// within limits.depth plies; SearchLimits::nodes and moveTimeMs bound the
+// effort. Entries are keyed by position and remaining plies, so the search
+// graph is acyclic and a proof found with fewer plies to spare also holds
+// with more. The table has a fixed size in small buckets; a full bucket
+// gives up the entry that took the least work to compute. Threads share the
+// table and steer away from children another thread is inside.
+class DfpnSolver {
+public:
+    explicit DfpnSolver(size_t tableMegabytes = 64, int threads = 1);
+    ~DfpnSolver();
+
+    void setTableSize(size_t megabytes);
+    void setThreads(int count) { threads = count < 1 ? 1 : count; }
+    // Tablebase results end the search early; distances, when stored, are
+    // checked against the horizon, and a win without one counts as in reach.
+    void setTablebase(const Tablebase* tb) { tablebase = tb; }
+
+    // The proof tree of a Win is extracted afterwards, re-proving subtrees
+    // the table has lost, and cut off after `maxTreeNodes` nodes.
+    SolveResult solve(const Position& pos, const SearchLimits& limits, size_t maxTreeNodes = 100000);
+    void stop() { stopRequested = true; }
+
+private:
+    struct Entry;
+    struct Bucket;
+    struct Child;
+    union ChildArray;
+    struct Frame;
+
+    bool lookup(uint64_t key, int remaining, uint32_t& pn, uint32_t& dn);
+    void store(uint64_t key, int remaining, uint32_t pn, uint32_t dn, uint64_t work);
+    void childValues(Child& child, int remaining, bool attacker);
+    void mid(const Position& pos, uint64_t key, int remaining, bool attacker, uint32_t thPhi, uint32_t thDelta,
+             uint32_t& phi, uint32_t& delta, Frame* frames, uint64_t& nodes);
+    bool prove(const Position& pos, uint64_t key, int remaining, bool attacker, Frame* frames, uint64_t& nodes);
+    ProofTreeStatus extract(const Position& pos, uint64_t key, int remaining, bool attacker,
+                 ProofNode& node, size_t& budget, Frame* frames, uint64_t& nodes);
+    void countNode(uint64_t& nodes);
+    bool stopped() const { return stopFlag.load(std::memory_order_relaxed); }
+
+    std::unique_ptr<Bucket[]> buckets;
+    size_t bucketCount = 0;
+    std::unique_ptr<std::atomic<uint8_t>[]> busy;
+    int threads = 1;
+    const Tablebase* tablebase = nullptr;
+
+    SearchLimits limits;
+    std::chrono::steady_clock::time_point startTime;
+    std::atomic<bool> stopRequested{false};
+    std::atomic<bool> stopFlag{false};
+    std::atomic<uint64_t> totalNodes{0};
+};
+
+// PDN of the proof with the defender's alternatives as variations; the
+// parser in pdn.h reads it back as the main line.
+std::string formatProofTree(const Position& start, const ProofNode& tree);
+
+// Walks a proof tree from `start`: one legal move at every attacker node,
+// every legal reply at every defender node, and each line ending within
+// `plies` in a position the defender cannot move in. Tablebase leaves are
+// taken on trust.
+bool checkProofTree(const Position& start, const ProofNode& tree, int plies);
+
+#endif // DFPN_H
@@ -0,0 +1,38 @@
+#include "eval.h"
+
+#include "eval_weights.h"
+
+namespace {
+
+const Bitboard CENTER = 0x00666600u;    // the two middle squares of rows 2-5
+const Bitboard WHITE_BACK_RANK = 0x0000000Fu;
+const Bitboard BLACK_BACK_RANK = 0xF0000000u;
+
+int rowSum(Bitboard men) {
+    int sum = 0;
+    while (men) sum += squareRow(popLowest(men));
+    return sum;
+}
+
+} // namespace
+
+void evalFeatures(const Position& pos, int features[EVAL_FEATURES]) {
+    Bitboard whiteMen = pos.white & ~pos.kings;
+    Bitboard blackMen = pos.black & ~pos.kings;
+    int blackMenCount = popCount(blackMen);
+
+    features[FeatureMan] = popCount(whiteMen) - blackMenCount;
+    features[FeatureKing] = popCount(pos.white & pos.kings) - popCount(pos.black & pos.kings);
+    features[FeatureTempo] = rowSum(whiteMen) - (7 * blackMenCount - rowSum(blackMen));
+    features[FeatureBackRank] = popCount(whiteMen & WHITE_BACK_RANK) - popCount(blackMen & BLACK_BACK_RANK);
+    features[FeatureCenter] = popCount(pos.white & CENTER) - popCount(pos.black & CENTER);
+}
+
+int evaluate(const Position& pos) {
+    int features[EVAL_FEATURES];
+    evalFeatures(pos, features);
+
+    int score = 0;
+    for (int i = 0; i < EVAL_FEATURES; ++i) score += EVAL_WEIGHTS[i] * features[i];
+    return pos.sideToMove == PieceColor::White ? score : -score;
+}
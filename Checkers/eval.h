@@ -0,0 +1,28 @@
+#ifndef EVAL_H
+#define EVAL_H
+
+#include "bitboard.h"
+
+const int MATE_SCORE = 30000;
+const int MATE_BOUND = MATE_SCORE - 1000;
+const int TABLEBASE_WIN_SCORE = MATE_BOUND - 500;
+
+// The evaluation is linear: White-minus-Black feature counts dotted with the
+// weights in eval_weights.h, which tools/tune regenerates from game records.
+enum EvalFeature {
+    FeatureMan,
+    FeatureKing,
+    FeatureTempo,       // rows advanced by men
+    FeatureBackRank,    // men still guarding the crowning row
+    FeatureCenter,      // pieces on the two middle squares of rows 2-5
+    EVAL_FEATURES
+};
+
+const char* const EVAL_FEATURE_NAMES[EVAL_FEATURES] = {"man", "king", "tempo", "back_rank", "center"};
+
+void evalFeatures(const Position& pos, int features[EVAL_FEATURES]);
+
+// Static evaluation in centipawn-like units from the side to move's view.
+int evaluate(const Position& pos);
+
+#endif // EVAL_H
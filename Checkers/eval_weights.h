@@ -0,0 +1,16 @@
+// Hand-set starting weights, in the layout tools/tune --header writes; a
+// tuning run replaces this file.
+#ifndef EVAL_WEIGHTS_H
+#define EVAL_WEIGHTS_H
+
+#include "eval.h"
+
+const int EVAL_WEIGHTS[EVAL_FEATURES] = {
+    100,    // man
+    250,    // king
+    3,      // tempo
+    8,      // back_rank
+    5,      // center
+};
+
+#endif // EVAL_WEIGHTS_H
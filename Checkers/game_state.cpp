@@ -0,0 +1,99 @@
+#include "game_state.h"
+
+#include "zobrist.h"
+
+namespace {
+
+int zobristPiece(PieceColor color, bool king) {
+    if (color == PieceColor::White) return king ? WhiteKing : WhiteMan;
+    return king ? BlackKing : BlackMan;
+}
+
+} // namespace
+
+GameState::GameState(const Position& pos) {
+    reset(pos);
+}
+
+void GameState::reset(const Position& start) {
+    pos = start;
+    key = hashPosition(pos);
+    men[0] = popCount(pos.white & ~pos.kings);
+    kings[0] = popCount(pos.white & pos.kings);
+    men[1] = popCount(pos.black & ~pos.kings);
+    kings[1] = popCount(pos.black & pos.kings);
+    undoStack.clear();
+    updateMobility();
+}
+
+void GameState::updateMobility() {
+    jumpers = ::capturers(pos);
+    steppers = jumpers ? 0 : movers(pos);
+}
+
+void GameState::makeMove(const Move& move) {
+    const ZobristKeys& keys = zobristKeys();
+    PieceColor us = pos.sideToMove;
+    PieceColor them = opponent(us);
+
+    Undo undo;
+    undo.move = move;
+    undo.key = key;
+    undo.jumpers = jumpers;
+    undo.steppers = steppers;
+    ::makeMove(pos, move, undo.info);
+
+    bool crowned = !undo.info.wasKing && move.promotion;
+    key ^= keys.pieces[zobristPiece(us, undo.info.wasKing)][move.from];
+    key ^= keys.pieces[zobristPiece(us, undo.info.wasKing || crowned)][move.to];
+    if (crowned) {
+        --men[colorIndex(us)];
+        ++kings[colorIndex(us)];
+    }
+
+    Bitboard captured = move.captured;
+    while (captured) {
+        int sq = popLowest(captured);
+        bool king = (undo.info.capturedKings & squareBit(sq)) != 0;
+        key ^= keys.pieces[zobristPiece(them, king)][sq];
+        if (king) --kings[colorIndex(them)];
+        else --men[colorIndex(them)];
+    }
+    key ^= keys.blackToMove;
+
+    undoStack.push_back(undo);
+    updateMobility();
+}
+
+void GameState::unmakeMove() {
+    const Undo& undo = undoStack.back();
+    const Move& move = undo.move;
+    ::unmakeMove(pos, move, undo.info);
+
+    PieceColor us = pos.sideToMove;
+    PieceColor them = opponent(us);
+    if (!undo.info.wasKing && move.promotion) {
+        ++men[colorIndex(us)];
+        --kings[colorIndex(us)];
+    }
+    int capturedKings = popCount(undo.info.capturedKings);
+    kings[colorIndex(them)] += capturedKings;
+    men[colorIndex(them)] += popCount(move.captured) - capturedKings;
+
+    key = undo.key;
+    jumpers = undo.jumpers;
+    steppers = undo.steppers;
+    undoStack.pop_back();
+}
+
+void GameState::keyHistory(std::vector<uint64_t>& keys) const {
+    keys.clear();
+    size_t first = undoStack.size();
+    while (first > 0) {
+        const Undo& undo = undoStack[first - 1];
+        if (undo.move.isCapture() || !undo.info.wasKing) break;
+        --first;
+    }
+    for (size_t i = first; i < undoStack.size(); ++i) keys.push_back(undoStack[i].key);
+    keys.push_back(key);
+}
@@ -0,0 +1,63 @@
+#ifndef GAME_STATE_H
+#define GAME_STATE_H
+
+#include <cstdint>
+#include <vector>
+
+#include "bitboard.h"
+
+// A position plus everything derived from it that callers ask for on every
+// move: per-side piece and king counts, the Zobrist key and the sets of
+// pieces that can capture or step. makeMove/unmakeMove keep them current
+// without rescanning the board; the undo stack doubles as the game record.
+class GameState {
+public:
+    explicit GameState(const Position& pos = Position::initial());
+
+    void reset(const Position& pos);
+
+    const Position& position() const { return pos; }
+    PieceColor sideToMove() const { return pos.sideToMove; }
+    uint64_t hash() const { return key; }
+
+    int pieceCount(PieceColor color) const { return men[colorIndex(color)] + kings[colorIndex(color)]; }
+    int kingCount(PieceColor color) const { return kings[colorIndex(color)]; }
+
+    Bitboard capturers() const { return jumpers; }
+    bool mustCapture() const { return jumpers != 0; }
+    // The side to move has no legal move, which loses the game.
+    bool isLost() const { return jumpers == 0 && steppers == 0; }
+
+    void generateMoves(MoveList& moves) const { ::generateMoves(pos, jumpers, moves); }
+
+    void makeMove(const Move& move);
+    void unmakeMove();
+
+    int ply() const { return static_cast<int>(undoStack.size()); }
+    const Move& moveAt(int ply) const { return undoStack[ply].move; }
+    // Keys of the positions since the last capture or man move, the current
+    // one last: nothing before such a move can occur again.
+    void keyHistory(std::vector<uint64_t>& keys) const;
+
+private:
+    struct Undo {
+        Move move;
+        UndoInfo info;
+        uint64_t key;
+        Bitboard jumpers;
+        Bitboard steppers;
+    };
+
+    static int colorIndex(PieceColor color) { return color == PieceColor::Black; }
+    void updateMobility();
+
+    Position pos;
+    uint64_t key = 0;
+    int men[2] = {};
+    int kings[2] = {};
+    Bitboard jumpers = 0;
+    Bitboard steppers = 0;
+    std::vector<Undo> undoStack;
+};
+
+#endif // GAME_STATE_H
@@ -0,0 +1,222 @@
+#ifndef GEOMETRY_H
+#define GEOMETRY_H
+
+#include <array>
+#include <cstdint>
+#include <type_traits>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// Board geometries for the rules core. Only the N*N/2 dark squares exist:
+// square index = row * N/2 + col / 2, with row 0 being White's back rank (the
+// top of the window) and the dark squares on odd columns of even rows. All
+// tables are built at compile time, one set per board size.
+
+// Directions are named in screen terms: White men move Down, Black men move Up.
+enum Direction { DownRight, DownLeft, UpRight, UpLeft };
+
+constexpr int oppositeDirection(int dir) { return dir ^ 3; }
+
+inline int lowestSquare(uint32_t b) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward(&index, b);
+    return static_cast<int>(index);
+#else
+    return __builtin_ctz(b);
+#endif
+}
+
+inline int lowestSquare(uint64_t b) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward64(&index, b);
+    return static_cast<int>(index);
+#else
+    return __builtin_ctzll(b);
+#endif
+}
+
+inline int highestSquare(uint32_t b) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanReverse(&index, b);
+    return static_cast<int>(index);
+#else
+    return 31 - __builtin_clz(b);
+#endif
+}
+
+inline int highestSquare(uint64_t b) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanReverse64(&index, b);
+    return static_cast<int>(index);
+#else
+    return 63 - __builtin_clzll(b);
+#endif
+}
+
+template <typename Mask>
+inline int popLowest(Mask& b) {
+    int sq = lowestSquare(b);
+    b &= b - 1;
+    return sq;
+}
+
+inline int popCount(uint32_t b) {
+#ifdef _MSC_VER
+    return static_cast<int>(__popcnt(b));
+#else
+    return __builtin_popcount(b);
+#endif
+}
+
+inline int popCount(uint64_t b) {
+#ifdef _MSC_VER
+    return static_cast<int>(__popcnt64(b));
+#else
+    return __builtin_popcountll(b);
+#endif
+}
+
+template <int N>
+using GeometryMask = typename std::conditional<(N * N / 2 <= 32), uint32_t, uint64_t>::type;
+
+template <int N>
+constexpr int geometryRow(int sq) { return sq / (N / 2); }
+
+template <int N>
+constexpr int geometryCol(int sq) { return sq % (N / 2) * 2 + ((geometryRow<N>(sq) & 1) ^ 1); }
+
+template <int N>
+constexpr int geometryIndex(int row, int col) {
+    return row < 0 || row >= N || col < 0 || col >= N || (row + col) % 2 == 0 ? -1 : row * (N / 2) + col / 2;
+}
+
+constexpr int directionRowStep(int dir) { return dir == DownRight || dir == DownLeft ? 1 : -1; }
+constexpr int directionColStep(int dir) { return dir == DownRight || dir == UpRight ? 1 : -1; }
+
+// Squares whose row has parity `parity`, or all squares for parity -1.
+template <int N>
+constexpr GeometryMask<N> geometryRowsMask(int firstRow, int lastRow, int parity) {
+    GeometryMask<N> mask = 0;
+    for (int sq = 0; sq < N * N / 2; ++sq) {
+        int row = geometryRow<N>(sq);
+        if (row >= firstRow && row <= lastRow && (parity < 0 || (row & 1) == parity)) mask |= GeometryMask<N>(1) << sq;
+    }
+    return mask;
+}
+
+template <int N>
+constexpr GeometryMask<N> geometryColumnMask(int col) {
+    GeometryMask<N> mask = 0;
+    for (int sq = 0; sq < N * N / 2; ++sq) {
+        if (geometryCol<N>(sq) == col) mask |= GeometryMask<N>(1) << sq;
+    }
+    return mask;
+}
+
+// NEIGHBORS[sq][dir]: the adjacent square, -1 off the board.
+template <int N>
+constexpr std::array<std::array<int8_t, 4>, N * N / 2> geometryNeighbors() {
+    std::array<std::array<int8_t, 4>, N * N / 2> table{};
+    for (int sq = 0; sq < N * N / 2; ++sq) {
+        for (int dir = 0; dir < 4; ++dir) {
+            int next = geometryIndex<N>(geometryRow<N>(sq) + directionRowStep(dir),
+                                        geometryCol<N>(sq) + directionColStep(dir));
+            table[sq][dir] = static_cast<int8_t>(next);
+        }
+    }
+    return table;
+}
+
+// RAYS[sq][dir]: every square from the neighbor to the edge of the board.
+template <int N>
+constexpr std::array<std::array<GeometryMask<N>, 4>, N * N / 2> geometryRays() {
+    std::array<std::array<GeometryMask<N>, 4>, N * N / 2> table{};
+    for (int sq = 0; sq < N * N / 2; ++sq) {
+        for (int dir = 0; dir < 4; ++dir) {
+            GeometryMask<N> ray = 0;
+            int row = geometryRow<N>(sq) + directionRowStep(dir);
+            int col = geometryCol<N>(sq) + directionColStep(dir);
+            for (int next = geometryIndex<N>(row, col); next >= 0; next = geometryIndex<N>(row, col)) {
+                ray |= GeometryMask<N>(1) << next;
+                row += directionRowStep(dir);
+                col += directionColStep(dir);
+            }
+            table[sq][dir] = ray;
+        }
+    }
+    return table;
+}
+
+template <int N>
+struct BoardGeometry {
+    static_assert(N % 2 == 0 && N >= 4 && N * N / 2 <= 64, "board must be even-sized and fit 64 dark squares");
+
+    typedef GeometryMask<N> Mask;
+
+    static constexpr int SIZE = N;
+    static constexpr int ROW_SQUARES = N / 2;
+    static constexpr int SQUARES = N * N / 2;
+    static constexpr int START_ROWS = N / 2 - 1;            // rows of men per side
+    static constexpr int MAX_CAPTURE_PATH = SQUARES / 2;    // more than a side's men
+
+    static constexpr Mask BOARD = geometryRowsMask<N>(0, N - 1, -1);
+    static constexpr Mask EVEN_ROWS = geometryRowsMask<N>(0, N - 1, 0);
+    static constexpr Mask ODD_ROWS = geometryRowsMask<N>(0, N - 1, 1);
+    static constexpr Mask FIRST_FILE = geometryColumnMask<N>(0);         // odd rows only
+    static constexpr Mask LAST_FILE = geometryColumnMask<N>(N - 1);      // even rows only
+    static constexpr Mask WHITE_PROMOTION = geometryRowsMask<N>(N - 1, N - 1, -1);
+    static constexpr Mask BLACK_PROMOTION = geometryRowsMask<N>(0, 0, -1);
+    static constexpr Mask WHITE_START = geometryRowsMask<N>(0, START_ROWS - 1, -1);
+    static constexpr Mask BLACK_START = geometryRowsMask<N>(N - START_ROWS, N - 1, -1);
+
+    static constexpr std::array<std::array<int8_t, 4>, SQUARES> NEIGHBORS = geometryNeighbors<N>();
+    static constexpr std::array<std::array<Mask, 4>, SQUARES> RAYS = geometryRays<N>();
+
+    static constexpr Mask bit(int sq) { return Mask(1) << sq; }
+    static constexpr int row(int sq) { return geometryRow<N>(sq); }
+    static constexpr int col(int sq) { return geometryCol<N>(sq); }
+    static constexpr int index(int row, int col) { return geometryIndex<N>(row, col); }
+
+    // The nearest square of `squares` seen from `sq` looking along `dir`;
+    // `squares` must lie on that ray. Down rays run towards higher indices.
+    static int nearest(Mask squares, int dir) {
+        return dir == DownRight || dir == DownLeft ? lowestSquare(squares) : highestSquare(squares);
+    }
+
+    // Every square of `b` moved one step in direction `Dir`, as whole-board
+    // shifts: the step is ROW_SQUARES plus or minus one depending on the row's
+    // parity, and the files masked out are those that would wrap around.
+    template <int Dir>
+    static constexpr Mask shift(Mask b) {
+        if (Dir == DownRight) {
+            return clip(((b & EVEN_ROWS & ~LAST_FILE) << (ROW_SQUARES + 1)) | ((b & ODD_ROWS) << ROW_SQUARES));
+        } else if (Dir == DownLeft) {
+            return clip(((b & EVEN_ROWS) << ROW_SQUARES) | ((b & ODD_ROWS & ~FIRST_FILE) << (ROW_SQUARES - 1)));
+        } else if (Dir == UpRight) {
+            return ((b & EVEN_ROWS & ~LAST_FILE) >> (ROW_SQUARES - 1)) | ((b & ODD_ROWS) >> ROW_SQUARES);
+        } else {
+            return ((b & EVEN_ROWS) >> ROW_SQUARES) | ((b & ODD_ROWS & ~FIRST_FILE) >> (ROW_SQUARES + 1));
+        }
+    }
+
+    static Mask shift(Mask b, int dir) {
+        switch (dir) {
+        case DownRight: return shift<DownRight>(b);
+        case DownLeft:  return shift<DownLeft>(b);
+        case UpRight:   return shift<UpRight>(b);
+        default:        return shift<UpLeft>(b);
+        }
+    }
+
+private:
+    // Drops bits shifted past the last square; a no-op when the board fills the mask.
+    static constexpr Mask clip(Mask b) { return b & BOARD; }
+};
+
+#endif // GEOMETRY_H
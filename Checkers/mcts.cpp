@@ -0,0 +1,256 @@
+#include "mcts.h"
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+#include "eval.h"
+#include "profiler.h"
+
+namespace {
+
+// Playout results in half points for the side to move.
+const int LOSS = 0;
+const int DRAW = 1;
+const int WIN = 2;
+
+const int VIRTUAL_LOSS = 3;
+const double EXPLORATION = 1.0;
+// Random games rarely end on their own; past this they are adjudicated by
+// the static evaluation, a margin of one and a half men deciding a win.
+const int MAX_PLAYOUT_PLIES = 120;
+const int ADJUDICATION_MARGIN = 150;
+// Searches with neither a time nor a playout limit stop here, since the
+// depth limit has no meaning for MCTS.
+const uint64_t DEFAULT_PLAYOUTS = 100000;
+
+enum NodeState : uint8_t { Unexpanded, Expanding, Expanded, Terminal };
+
+uint64_t nextRandom(uint64_t& state) {
+    state ^= state >> 12;
+    state ^= state << 25;
+    state ^= state >> 27;
+    return state * 2685821657736338717ULL;
+}
+
+int playout(Position pos, uint64_t& rng) {
+    PieceColor side = pos.sideToMove;
+    MoveList moves;
+    for (int ply = 0; ply < MAX_PLAYOUT_PLIES; ++ply) {
+        generateMoves(pos, moves);
+        if (moves.empty()) return pos.sideToMove == side ? LOSS : WIN;
+        makeMove(pos, moves[nextRandom(rng) % moves.size()]);
+    }
+    int score = evaluate(pos);
+    if (pos.sideToMove != side) score = -score;
+    return score > ADJUDICATION_MARGIN ? WIN : score < -ADJUDICATION_MARGIN ? LOSS : DRAW;
+}
+
+} // namespace
+
+// `visits` includes the virtual losses of descents still in flight; `reward`
+// is in half points for the side that played `move`. The plain fields are
+// written before `state` is released as Expanded and never change after.
+struct MctsEngine::Node {
+    Move move;
+    uint32_t firstChild = 0;
+    uint16_t childCount = 0;
+    std::atomic<uint8_t> state{Unexpanded};
+    std::atomic<int32_t> visits{0};
+    std::atomic<int64_t> reward{0};
+
+    void reset(const Move& edge) {
+        move = edge;
+        firstChild = 0;
+        childCount = 0;
+        state.store(Unexpanded, std::memory_order_relaxed);
+        visits.store(0, std::memory_order_relaxed);
+        reward.store(0, std::memory_order_relaxed);
+    }
+};
+
+MctsEngine::MctsEngine(size_t treeMegabytes, int threads) {
+    setTreeSize(treeMegabytes);
+    setThreads(threads);
+}
+
+MctsEngine::~MctsEngine() = default;
+
+// The arena itself is allocated by the first search, so an engine that is
+// never asked to move costs nothing.
+void MctsEngine::setTreeSize(size_t megabytes) {
+    // Room for the root and one full expansion at the very least.
+    capacity = std::max<size_t>(megabytes * 1024 * 1024 / sizeof(Node), MAX_MOVES + 1);
+    nodes.reset();
+}
+
+size_t MctsEngine::arenaBytes() const {
+    return capacity * sizeof(Node);
+}
+
+// Index of `count` consecutive fresh nodes, 0 once the arena is exhausted
+// (index 0 is always the root, so it never names a child block).
+uint32_t MctsEngine::allocate(int count) {
+    size_t first = used.fetch_add(count, std::memory_order_relaxed);
+    if (first + count > capacity) return 0;
+    return static_cast<uint32_t>(first);
+}
+
+// Returns true if this thread expanded `node`; otherwise another thread owns
+// the expansion or the arena is full, and the caller plays out instead.
+bool MctsEngine::expand(Node& node, const Position& pos) {
+    if (arenaFull.load(std::memory_order_relaxed)) return false;
+    uint8_t expected = Unexpanded;
+    if (!node.state.compare_exchange_strong(expected, Expanding, std::memory_order_acquire)) return false;
+
+    MoveList moves;
+    generateMoves(pos, moves);
+    if (moves.empty()) {
+        node.state.store(Terminal, std::memory_order_release);
+        return true;
+    }
+
+    uint32_t first = allocate(static_cast<int>(moves.size()));
+    if (first == 0) {
+        arenaFull = true;
+        node.state.store(Unexpanded, std::memory_order_release);
+        return false;
+    }
+    for (size_t i = 0; i < moves.size(); ++i) nodes[first + i].reset(moves[i]);
+    node.firstChild = first;
+    node.childCount = static_cast<uint16_t>(moves.size());
+    node.state.store(Expanded, std::memory_order_release);
+    return true;
+}
+
+uint32_t MctsEngine::selectChild(const Node& node) const {
+    double logParent = std::log(std::max(1, node.visits.load(std::memory_order_relaxed)));
+    uint32_t best = node.firstChild;
+    double bestValue = -1;
+    for (uint32_t i = node.firstChild; i < node.firstChild + node.childCount; ++i) {
+        int visits = nodes[i].visits.load(std::memory_order_relaxed);
+        if (visits == 0) return i;
+        double value = nodes[i].reward.load(std::memory_order_relaxed) / (2.0 * visits) +
+                       EXPLORATION * std::sqrt(logParent / visits);
+        if (value > bestValue) {
+            bestValue = value;
+            best = i;
+        }
+    }
+    return best;
+}
+
+// One descent, playout and backup. Every node on the path is charged
+// VIRTUAL_LOSS visits without reward on the way down; the backup replaces
+// them with the single real visit.
+void MctsEngine::iterate(const Position& root, uint64_t& rng) {
+    uint32_t path[MAX_PLY + 1];
+    int length = 0;
+    Position pos = root;
+    uint32_t index = 0;
+    int score;
+
+    while (true) {
+        Node& node = nodes[index];
+        node.visits.fetch_add(VIRTUAL_LOSS, std::memory_order_relaxed);
+        path[length++] = index;
+
+        uint8_t state = node.state.load(std::memory_order_acquire);
+        if (state == Expanded) {
+            index = selectChild(node);
+            makeMove(pos, nodes[index].move);
+            continue;
+        }
+        if (state == Unexpanded && length <= MAX_PLY && expand(node, pos)) {
+            state = node.state.load(std::memory_order_acquire);
+        }
+        score = state == Terminal ? LOSS : playout(pos, rng);
+        break;
+    }
+
+    // `score` is for the side to move at the leaf, the reward of each node
+    // for the side that moved into it.
+    for (int i = length - 1; i >= 0; --i) {
+        Node& node = nodes[path[i]];
+        score = WIN - score;
+        node.reward.fetch_add(score, std::memory_order_relaxed);
+        node.visits.fetch_add(1 - VIRTUAL_LOSS, std::memory_order_relaxed);
+    }
+    playouts.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool MctsEngine::shouldStop() const {
+    if (stopRequested.load(std::memory_order_relaxed)) return true;
+    if (limits.cancel && limits.cancel->load(std::memory_order_relaxed)) return true;
+    if (limits.nodes && playouts.load(std::memory_order_relaxed) >= limits.nodes) return true;
+    if (limits.moveTimeMs > 0) {
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - startTime;
+        if (elapsed.count() >= limits.moveTimeMs) return true;
+    }
+    return false;
+}
+
+MctsResult MctsEngine::search(const Position& pos, const SearchLimits& searchLimits) {
+    PROFILE_ZONE("MctsEngine::search");
+    if (!nodes) nodes.reset(new Node[capacity]);
+    limits = searchLimits;
+    if (limits.moveTimeMs <= 0 && limits.nodes == 0) limits.nodes = DEFAULT_PLAYOUTS;
+    startTime = std::chrono::steady_clock::now();
+    stopRequested = false;
+    playouts = 0;
+
+    MctsResult result;
+    MoveList rootMoves;
+    generateMoves(pos, rootMoves);
+    if (rootMoves.empty()) return result;
+
+    result.bestMove = rootMoves.front();
+    result.hasMove = true;
+    result.pv.push_back(result.bestMove);
+    if (rootMoves.size() == 1 && limits.moveTimeMs > 0) return result;
+
+    // The previous tree is dropped as a whole; nodes are reinitialized as
+    // they are handed out again.
+    used = 1;
+    arenaFull = false;
+    nodes[0].reset(Move());
+
+    uint64_t seed = static_cast<uint64_t>(startTime.time_since_epoch().count());
+    std::vector<std::thread> helpers;
+    for (int i = 1; i < threads; ++i) {
+        helpers.emplace_back([this, &pos, seed, i]() {
+            uint64_t rng = (seed + i * 0x9E3779B97F4A7C15ULL) | 1;
+            while (!shouldStop()) iterate(pos, rng);
+        });
+    }
+    uint64_t rng = seed | 1;
+    while (!shouldStop()) iterate(pos, rng);
+    stopRequested = true;
+    for (auto& helper : helpers) helper.join();
+
+    // The most visited line; the root move's visits decide, as usual for UCT.
+    result.pv.clear();
+    const Node* node = &nodes[0];
+    while (node->state.load(std::memory_order_acquire) == Expanded) {
+        const Node* best = nullptr;
+        for (uint32_t i = node->firstChild; i < node->firstChild + node->childCount; ++i) {
+            if (!best || nodes[i].visits > best->visits) best = &nodes[i];
+        }
+        if (best->visits == 0) break;
+        if (node == &nodes[0]) {
+            result.bestMove = best->move;
+            result.expectedScore = best->reward / (2.0 * best->visits);
+        }
+        result.pv.push_back(best->move);
+        node = best;
+    }
+    if (result.pv.empty()) result.pv.push_back(result.bestMove);
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - startTime;
+    result.seconds = elapsed.count();
+    result.playouts = playouts;
+    result.treeNodes = std::min(used.load(), capacity);
+    result.treeBytes = result.treeNodes * sizeof(Node);
+    PROFILE_COUNTER("mcts playouts", static_cast<int64_t>(result.playouts));
+    return result;
+}
@@ -0,0 +1,69 @@
+#ifndef MCTS_H
+#define MCTS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "bitboard.h"
+#include "search.h"
+
+struct MctsResult {
+    Move bestMove;
+    bool hasMove = false;
+    double expectedScore = 0;   // of bestMove for the side to move: 1 win, 0.5 draw
+    uint64_t playouts = 0;
+    double seconds = 0;
+    size_t treeNodes = 0;
+    size_t treeBytes = 0;       // arena in use, out of MctsEngine::arenaBytes()
+    std::vector<Move> pv;       // most visited line
+};
+
+// Monte Carlo tree search: UCT selection, random playouts driven by the
+// regular move generator. With more than one thread all of them descend the
+// same tree (tree parallelism); a descent charges a virtual loss to its path
+// so concurrent descents spread over different lines, and a leaf is expanded
+// by whichever thread wins a CAS on it. Nodes are carved out of a
+// preallocated arena that is reset wholesale before every search; once it is
+// full, leaves stop being expanded and are only played out.
+class MctsEngine {
+public:
+    explicit MctsEngine(size_t treeMegabytes = 64, int threads = 1);
+    ~MctsEngine();
+
+    void setTreeSize(size_t megabytes);
+    void setThreads(int count) { threads = count < 1 ? 1 : count; }
+    int threadCount() const { return threads; }
+    size_t arenaBytes() const;
+
+    // Blocks until the time limit, the playout limit (SearchLimits::nodes) or
+    // stop() from another thread; the depth limit does not apply, and without
+    // a time or playout limit the search stops after a default playout count.
+    MctsResult search(const Position& pos, const SearchLimits& limits);
+    void stop() { stopRequested = true; }
+
+private:
+    struct Node;
+
+    uint32_t allocate(int count);
+    bool expand(Node& node, const Position& pos);
+    uint32_t selectChild(const Node& node) const;
+    void iterate(const Position& root, uint64_t& rng);
+    bool shouldStop() const;
+
+    std::unique_ptr<Node[]> nodes;
+    size_t capacity = 0;
+    std::atomic<size_t> used{0};
+    std::atomic<bool> arenaFull{false};
+    int threads = 1;
+
+    SearchLimits limits;
+    std::chrono::steady_clock::time_point startTime;
+    std::atomic<bool> stopRequested{false};
+    std::atomic<uint64_t> playouts{0};
+};
+
+#endif // MCTS_H
@@ -0,0 +1,172 @@
+#include "notation.h"
+
+#include <algorithm>
+#include <cctype>
+
+namespace {
+
+std::string trim(const std::string& s) {
+    size_t begin = 0;
+    size_t end = s.size();
+    while (begin < end && std::isspace(static_cast<unsigned char>(s[begin]))) ++begin;
+    while (end > begin && std::isspace(static_cast<unsigned char>(s[end - 1]))) --end;
+    return s.substr(begin, end - begin);
+}
+
+void appendPieces(std::string& out, Bitboard pieces, Bitboard kings) {
+    bool first = true;
+    while (pieces) {
+        int sq = popLowest(pieces);
+        if (!first) out += ',';
+        if (kings & squareBit(sq)) out += 'K';
+        out += squareName(sq);
+        first = false;
+    }
+}
+
+bool parsePieceList(const std::string& list, PieceColor color, Position& pos) {
+    size_t start = 0;
+    while (start <= list.size()) {
+        size_t comma = list.find(',', start);
+        if (comma == std::string::npos) comma = list.size();
+        std::string token = trim(list.substr(start, comma - start));
+        start = comma + 1;
+        if (token.empty()) continue;
+
+        Piece piece{PieceType::Man, color};
+        if (token[0] == 'K' || token[0] == 'k') {
+            piece.type = PieceType::King;
+            token = token.substr(1);
+        }
+        int sq = parseSquare(token);
+        if (sq < 0) return false;
+        pos.setPiece(sq, piece);
+    }
+    return true;
+}
+
+} // namespace
+
+std::string squareName(int sq) {
+    std::string name;
+    name += static_cast<char>('a' + (7 - squareCol(sq)));
+    name += static_cast<char>('1' + squareRow(sq));
+    return name;
+}
+
+int parseSquare(const std::string& name) {
+    if (name.size() != 2) return -1;
+    int file = std::tolower(static_cast<unsigned char>(name[0])) - 'a';
+    int rank = name[1] - '1';
+    if (file < 0 || file > 7 || rank < 0 || rank > 7) return -1;
+    return squareIndex(rank, 7 - file);
+}
+
+std::string moveToString(const Move& move) {
+    std::string out = squareName(move.from);
+    char separator = move.isCapture() ? ':' : '-';
+    for (int i = 0; i < move.pathLength; ++i) {
+        out += separator;
+        out += squareName(move.path[i]);
+    }
+    return out;
+}
+
+bool parseMove(const Position& pos, const std::string& text, Move& move) {
+    std::string trimmed = trim(text);
+    return parseMove(pos, trimmed.data(), trimmed.size(), move);
+}
+
+bool parseMove(const Position& pos, const char* text, size_t length, Move& move) {
+    int squares[MAX_CAPTURE_PATH + 1];
+    int count = 0;
+    size_t i = 0;
+    while (true) {
+        if (i + 2 > length || count > MAX_CAPTURE_PATH) return false;
+        int file = std::tolower(static_cast<unsigned char>(text[i])) - 'a';
+        int rank = text[i + 1] - '1';
+        if (file < 0 || file > 7 || rank < 0 || rank > 7) return false;
+        int sq = squareIndex(rank, 7 - file);
+        if (sq < 0) return false;
+        squares[count++] = sq;
+        i += 2;
+        if (i == length) break;
+        if (text[i] != '-' && text[i] != ':' && text[i] != 'x') return false;
+        ++i;
+    }
+    if (count < 2) return false;
+
+    MoveList moves;
+    generateMoves(pos, moves);
+    int matches = 0;
+    for (const auto& candidate : moves) {
+        if (candidate.from != squares[0] || candidate.to != squares[count - 1]) continue;
+        if (count > 2) {
+            if (candidate.pathLength != count - 1) continue;
+            if (!std::equal(squares + 1, squares + count, candidate.path)) continue;
+        }
+        move = candidate;
+        ++matches;
+    }
+    return matches == 1;
+}
+
+std::string boardToString(const Position& pos) {
+    std::string out;
+    for (int row = 7; row >= 0; --row) {
+        out += static_cast<char>('1' + row);
+        out += ' ';
+        for (int col = 7; col >= 0; --col) {
+            int sq = squareIndex(row, col);
+            char c = ' ';
+            if (sq >= 0) {
+                Piece piece = pos.pieceAt(sq);
+                if (piece.color == PieceColor::None) c = '.';
+                else c = piece.color == PieceColor::White ? 'w' : 'b';
+                if (piece.type == PieceType::King) c = static_cast<char>(std::toupper(c));
+            }
+            out += c;
+            out += ' ';
+        }
+        out += '\n';
+    }
+    out += "  a b c d e f g h\n";
+    return out;
+}
+
+std::string toFen(const Position& pos) {
+    std::string fen = pos.sideToMove == PieceColor::White ? "W" : "B";
+    fen += ":W";
+    appendPieces(fen, pos.white, pos.kings);
+    fen += ":B";
+    appendPieces(fen, pos.black, pos.kings);
+    return fen;
+}
+
+bool parseFen(const std::string& fen, Position& pos) {
+    Position result;
+    std::string text = trim(fen);
+    if (!text.empty() && text.back() == '.') text.pop_back();
+    if (text.empty()) return false;
+
+    char side = static_cast<char>(std::toupper(static_cast<unsigned char>(text[0])));
+    if (side != 'W' && side != 'B') return false;
+    result.sideToMove = side == 'W' ? PieceColor::White : PieceColor::Black;
+
+    size_t start = text.find(':');
+    while (start != std::string::npos) {
+        size_t next = text.find(':', start + 1);
+        std::string field = trim(text.substr(start + 1, next == std::string::npos ? std::string::npos : next - start - 1));
+        start = next;
+        if (field.empty()) continue;
+
+        char color = static_cast<char>(std::toupper(static_cast<unsigned char>(field[0])));
+        if (color != 'W' && color != 'B') return false;
+        if (!parsePieceList(field.substr(1), color == 'W' ? PieceColor::White : PieceColor::Black, result)) {
+            return false;
+        }
+    }
+
+    pos = result;
+    return true;
+}
@@ -0,0 +1,30 @@
+#ifndef NOTATION_H
+#define NOTATION_H
+
+#include <cstddef>
+#include <string>
+
+#include "bitboard.h"
+
+// Russian-draughts algebraic notation: a1 is White's lower-left dark square
+// (row 0, col 7 in GUI terms). FEN strings look like "W:Wa1,c1,Kd4:Bh8,f8"
+// with a K prefix for kings; moves are "c3-d4" or "c3:e5:c7".
+
+std::string squareName(int sq);
+int parseSquare(const std::string& name);
+
+std::string moveToString(const Move& move);
+
+// Matches "c3-d4", "c3:e5" or a full capture path against the legal moves of
+// `pos`; fails if the text is malformed, illegal or ambiguous.
+bool parseMove(const Position& pos, const std::string& text, Move& move);
+// Same on a trimmed character range, without allocating.
+bool parseMove(const Position& pos, const char* text, size_t length, Move& move);
+
+// Plain-text diagram with rank 8 at the top: w/b for men, W/B for kings.
+std::string boardToString(const Position& pos);
+
+std::string toFen(const Position& pos);
+bool parseFen(const std::string& fen, Position& pos);
+
+#endif // NOTATION_H
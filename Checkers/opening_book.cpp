@@ -0,0 +1,240 @@
+#include "opening_book.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#include "zobrist.h"
+
+namespace {
+
+const char MAGIC[4] = {'C', 'K', 'B', 'K'};
+const uint32_t VERSION = 1;
+
+struct BookHeader {
+    char magic[4];
+    uint32_t version;
+    uint64_t positionCount;
+    uint64_t moveCount;
+    uint32_t maxPly;
+    uint32_t reserved;
+};
+static_assert(sizeof(BookHeader) == 32, "opening book header must be packed");
+
+enum SampleOutcome : uint8_t { SampleLoss, SampleDraw, SampleWin };
+
+// One (position, move, result) occurrence collected from the games.
+struct Sample {
+    uint64_t key;
+    Bitboard captured;
+    uint8_t from;
+    uint8_t to;
+    uint8_t outcome;
+};
+
+bool sampleLess(const Sample& a, const Sample& b) {
+    if (a.key != b.key) return a.key < b.key;
+    if (a.from != b.from) return a.from < b.from;
+    if (a.to != b.to) return a.to < b.to;
+    return a.captured < b.captured;
+}
+
+bool sameMove(const Sample& a, const Sample& b) {
+    return a.key == b.key && a.from == b.from && a.to == b.to && a.captured == b.captured;
+}
+
+// False for unfinished games; `winner` is None for a draw.
+bool gameWinner(const std::string& result, PieceColor& winner) {
+    winner = result == "2-0" ? PieceColor::White : result == "0-2" ? PieceColor::Black : PieceColor::None;
+    return result == "2-0" || result == "0-2" || result == "1-1";
+}
+
+} // namespace
+
+struct OpeningBook::PositionRecord {
+    uint64_t key;
+    uint32_t firstMove;
+    uint32_t moveCount;
+};
+
+struct OpeningBook::MoveRecord {
+    uint8_t from;
+    uint8_t to;
+    uint16_t reserved;
+    Bitboard captured;
+    uint32_t weight;
+    uint32_t wins;
+    uint32_t draws;
+    uint32_t losses;
+};
+
+bool buildOpeningBook(const PdnDatabase& games, const std::string& path,
+                      const OpeningBookOptions& options, OpeningBookStats* stats) {
+    int threads = std::max(1, options.threads);
+    std::vector<std::vector<Sample>> perWorker(threads);
+
+    PdnStats scanned = games.forEachGame(threads, [&](int worker, uint64_t, const PdnGame& game) {
+        PieceColor winner;
+        if (!gameWinner(game.result, winner)) return;
+
+        Position pos = game.start;
+        size_t plies = std::min(game.moves.size(), static_cast<size_t>(options.maxPly));
+        for (size_t i = 0; i < plies; ++i) {
+            const Move& move = game.moves[i];
+            Sample sample;
+            sample.key = hashPosition(pos);
+            sample.captured = move.captured;
+            sample.from = move.from;
+            sample.to = move.to;
+            sample.outcome = winner == PieceColor::None ? SampleDraw :
+                             winner == pos.sideToMove ? SampleWin : SampleLoss;
+            perWorker[worker].push_back(sample);
+            makeMove(pos, move);
+        }
+    });
+
+    std::vector<Sample> samples;
+    size_t total = 0;
+    for (const auto& part : perWorker) total += part.size();
+    samples.reserve(total);
+    for (auto& part : perWorker) {
+        samples.insert(samples.end(), part.begin(), part.end());
+        std::vector<Sample>().swap(part);
+    }
+    std::sort(samples.begin(), samples.end(), sampleLess);
+
+    std::vector<OpeningBook::PositionRecord> positionTable;
+    std::vector<OpeningBook::MoveRecord> moveTable;
+    for (size_t i = 0; i < samples.size();) {
+        size_t j = i;
+        OpeningBook::MoveRecord record = {};
+        record.from = samples[i].from;
+        record.to = samples[i].to;
+        record.captured = samples[i].captured;
+        for (; j < samples.size() && sameMove(samples[i], samples[j]); ++j) {
+            if (samples[j].outcome == SampleWin) ++record.wins;
+            else if (samples[j].outcome == SampleDraw) ++record.draws;
+            else ++record.losses;
+        }
+        uint32_t played = record.wins + record.draws + record.losses;
+        record.weight = 2 * record.wins + record.draws;
+
+        if (played >= static_cast<uint32_t>(options.minGames)) {
+            if (positionTable.empty() || positionTable.back().key != samples[i].key) {
+                OpeningBook::PositionRecord position = {samples[i].key, static_cast<uint32_t>(moveTable.size()), 0};
+                positionTable.push_back(position);
+            }
+            ++positionTable.back().moveCount;
+            moveTable.push_back(record);
+        }
+        i = j;
+    }
+
+    BookHeader header = {};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.positionCount = positionTable.size();
+    header.moveCount = moveTable.size();
+    header.maxPly = static_cast<uint32_t>(options.maxPly);
+
+    if (stats) {
+        stats->games = scanned;
+        stats->positions = positionTable.size();
+        stats->moves = moveTable.size();
+    }
+
+    FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) return false;
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+              std::fwrite(positionTable.data(), sizeof(OpeningBook::PositionRecord), positionTable.size(), file) ==
+                  positionTable.size() &&
+              std::fwrite(moveTable.data(), sizeof(OpeningBook::MoveRecord), moveTable.size(), file) ==
+                  moveTable.size();
+    return std::fclose(file) == 0 && ok;
+}
+
+bool OpeningBook::open(const std::string& path) {
+    static_assert(sizeof(PositionRecord) == 16, "book position records must be packed");
+    static_assert(sizeof(MoveRecord) == 24, "book move records must be packed");
+
+    close();
+    if (!file.open(path) || file.size() < sizeof(BookHeader)) {
+        file.close();
+        return false;
+    }
+
+    BookHeader header;
+    std::memcpy(&header, file.data(), sizeof(header));
+    uint64_t expected = sizeof(header) + header.positionCount * sizeof(PositionRecord) +
+                        header.moveCount * sizeof(MoveRecord);
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION ||
+        file.size() != expected) {
+        file.close();
+        return false;
+    }
+
+    positions = reinterpret_cast<const PositionRecord*>(file.data() + sizeof(header));
+    moveRecords = reinterpret_cast<const MoveRecord*>(positions + header.positionCount);
+    count = header.positionCount;
+    moveCount = header.moveCount;
+    return true;
+}
+
+void OpeningBook::close() {
+    file.close();
+    positions = nullptr;
+    moveRecords = nullptr;
+    count = 0;
+    moveCount = 0;
+}
+
+bool OpeningBook::probe(const Position& pos, std::vector<BookMove>& moves) const {
+    moves.clear();
+    if (!positions) return false;
+
+    uint64_t key = hashPosition(pos);
+    const PositionRecord* end = positions + count;
+    const PositionRecord* it = std::lower_bound(positions, end, key,
+        [](const PositionRecord& record, uint64_t value) { return record.key < value; });
+    if (it == end || it->key != key || uint64_t(it->firstMove) + it->moveCount > moveCount) return false;
+
+    // Resolving against the legal moves also rejects key collisions.
+    MoveList legal;
+    generateMoves(pos, legal);
+    for (uint32_t i = 0; i < it->moveCount; ++i) {
+        const MoveRecord& record = moveRecords[it->firstMove + i];
+        for (const auto& move : legal) {
+            if (move.from != record.from || move.to != record.to || move.captured != record.captured) continue;
+            BookMove entry;
+            entry.move = move;
+            entry.weight = record.weight;
+            entry.wins = record.wins;
+            entry.draws = record.draws;
+            entry.losses = record.losses;
+            moves.push_back(entry);
+            break;
+        }
+    }
+    std::stable_sort(moves.begin(), moves.end(),
+                     [](const BookMove& a, const BookMove& b) { return a.weight > b.weight; });
+    return !moves.empty();
+}
+
+bool OpeningBook::pickMove(const Position& pos, uint64_t random, Move& move) const {
+    std::vector<BookMove> moves;
+    if (!probe(pos, moves)) return false;
+
+    uint64_t total = 0;
+    for (const auto& entry : moves) total += entry.weight;
+    if (total == 0) return false;
+
+    uint64_t target = random % total;
+    for (const auto& entry : moves) {
+        if (target < entry.weight) {
+            move = entry.move;
+            return true;
+        }
+        target -= entry.weight;
+    }
+    return false;
+}
@@ -0,0 +1,69 @@
+#ifndef OPENING_BOOK_H
+#define OPENING_BOOK_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "bitboard.h"
+#include "mapped_file.h"
+#include "pdn.h"
+
+// Opening book file: a 32-byte header, then one 16-byte record per position
+// sorted by Zobrist key, then the move records of all positions, each
+// position's moves contiguous. Lookups binary-search the mapped position
+// table, so opening a book costs a single mmap whatever its size.
+
+struct BookMove {
+    Move move;
+    uint32_t weight = 0;    // relative probability of playing the move
+    uint32_t wins = 0;      // from the point of view of the side playing it
+    uint32_t draws = 0;
+    uint32_t losses = 0;
+};
+
+struct OpeningBookOptions {
+    int maxPly = 24;        // positions deeper into the game are not stored
+    int minGames = 2;       // moves played fewer times are dropped
+    int threads = 1;
+};
+
+struct OpeningBookStats {
+    PdnStats games;
+    uint64_t positions = 0;
+    uint64_t moves = 0;
+};
+
+bool buildOpeningBook(const PdnDatabase& games, const std::string& path,
+                      const OpeningBookOptions& options, OpeningBookStats* stats = nullptr);
+
+class OpeningBook {
+public:
+    bool open(const std::string& path);
+    void close();
+    bool isOpen() const { return positions != nullptr; }
+    uint64_t positionCount() const { return count; }
+
+    // Book moves that are legal in `pos`, best weight first; false when the
+    // position is not in the book.
+    bool probe(const Position& pos, std::vector<BookMove>& moves) const;
+
+    // Picks a move with probability proportional to its weight; `random` is
+    // any uniformly distributed 64-bit value.
+    bool pickMove(const Position& pos, uint64_t random, Move& move) const;
+
+private:
+    friend bool buildOpeningBook(const PdnDatabase&, const std::string&, const OpeningBookOptions&, OpeningBookStats*);
+
+    struct PositionRecord;
+    struct MoveRecord;
+
+    MappedFile file;
+    const PositionRecord* positions = nullptr;
+    const MoveRecord* moveRecords = nullptr;
+    uint64_t count = 0;
+    uint64_t moveCount = 0;
+};
+
+#endif // OPENING_BOOK_H
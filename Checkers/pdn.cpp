@@ -0,0 +1,321 @@
+#include "pdn.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <mutex>
+#include <thread>
+
+#include "notation.h"
+
+namespace {
+
+const size_t LINE_WIDTH = 80;
+const size_t CHUNK_BYTES = size_t(1) << 22;
+
+bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v';
+}
+
+bool isDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+std::string escapeTag(const std::string& value) {
+    std::string out;
+    for (char c : value) {
+        if (c == '"' || c == '\\') out += '\\';
+        out += c;
+    }
+    return out;
+}
+
+// Maps every result spelling to the 2-point form, or returns null.
+const char* resultToken(const char* token, size_t length) {
+    static const char* const spellings[][2] = {
+        {"2-0", "2-0"}, {"0-2", "0-2"}, {"1-1", "1-1"}, {"1-0", "2-0"},
+        {"0-1", "0-2"}, {"1/2-1/2", "1-1"}, {"*", "*"},
+    };
+    for (const auto& spelling : spellings) {
+        if (std::strlen(spelling[0]) == length && std::memcmp(spelling[0], token, length) == 0) {
+            return spelling[1];
+        }
+    }
+    return nullptr;
+}
+
+// Skips a balanced {...} comment or (...) variation starting at `p`.
+const char* skipBlock(const char* p, const char* end) {
+    char open = *p;
+    char close = open == '{' ? '}' : ')';
+    int level = 0;
+    for (; p < end; ++p) {
+        if (*p == open) ++level;
+        else if (*p == close && --level == 0) return p + 1;
+    }
+    return end;
+}
+
+const char* skipLine(const char* p, const char* end) {
+    const void* newline = std::memchr(p, '\n', end - p);
+    return newline ? static_cast<const char*>(newline) + 1 : end;
+}
+
+size_t skipBom(const char* text, size_t length) {
+    return length >= 3 && std::memcmp(text, "\xEF\xBB\xBF", 3) == 0 ? 3 : 0;
+}
+
+bool fail(std::string* error, const std::string& message) {
+    if (error) *error = message;
+    return false;
+}
+
+// Reads `[Name "value"]` at `p`; returns the position after the bracket.
+const char* parseTag(const char* p, const char* end, std::string& name, std::string& value) {
+    ++p;
+    while (p < end && isSpace(*p)) ++p;
+    const char* nameBegin = p;
+    while (p < end && !isSpace(*p) && *p != '"' && *p != ']') ++p;
+    name.assign(nameBegin, p);
+    value.clear();
+
+    while (p < end && *p != '"' && *p != ']') ++p;
+    if (p < end && *p == '"') {
+        for (++p; p < end && *p != '"'; ++p) {
+            if (*p == '\\' && p + 1 < end) ++p;
+            value += *p;
+        }
+        if (p < end) ++p;
+    }
+    while (p < end && *p != ']' && *p != '\n') ++p;
+    return p < end && *p == ']' ? p + 1 : p;
+}
+
+void appendWrapped(std::string& out, size_t& lineLength, const std::string& token) {
+    if (lineLength > 0 && lineLength + 1 + token.size() > LINE_WIDTH) {
+        out += '\n';
+        lineLength = 0;
+    } else if (lineLength > 0) {
+        out += ' ';
+        ++lineLength;
+    }
+    out += token;
+    lineLength += token.size();
+}
+
+} // namespace
+
+std::string PdnGame::tag(const std::string& name) const {
+    for (const auto& entry : tags) {
+        if (entry.first == name) return entry.second;
+    }
+    return "";
+}
+
+void PdnGame::setTag(const std::string& name, const std::string& value) {
+    for (auto& entry : tags) {
+        if (entry.first == name) {
+            entry.second = value;
+            return;
+        }
+    }
+    tags.emplace_back(name, value);
+}
+
+std::string formatPdn(const PdnGame& game) {
+    std::string out;
+    std::string gameType = game.tag("GameType");
+    out += "[GameType \"" + (gameType.empty() ? std::string("25") : gameType) + "\"]\n";
+    for (const auto& entry : game.tags) {
+        if (entry.first == "GameType" || entry.first == "FEN" || entry.first == "Result") continue;
+        out += "[" + entry.first + " \"" + escapeTag(entry.second) + "\"]\n";
+    }
+    if (!(game.start == Position::initial())) out += "[FEN \"" + toFen(game.start) + "\"]\n";
+    out += "[Result \"" + game.result + "\"]\n\n";
+
+    size_t lineLength = 0;
+    int moveNumber = 1;
+    bool whiteToMove = game.start.sideToMove == PieceColor::White;
+    for (size_t i = 0; i < game.moves.size(); ++i) {
+        std::string token;
+        if (whiteToMove) token = std::to_string(moveNumber) + ". ";
+        else if (i == 0) token = std::to_string(moveNumber) + "... ";
+        token += moveToString(game.moves[i]);
+        appendWrapped(out, lineLength, token);
+
+        if (!whiteToMove) ++moveNumber;
+        whiteToMove = !whiteToMove;
+    }
+    appendWrapped(out, lineLength, game.result);
+    out += "\n\n";
+    return out;
+}
+
+bool parsePdnGame(const char* text, size_t length, PdnGame& game, std::string* error) {
+    game.tags.clear();
+    game.start = Position::initial();
+    game.moves.clear();
+    game.result = "*";
+
+    const char* p = text;
+    const char* end = text + length;
+    p += skipBom(text, length);
+
+    Position pos = game.start;
+    std::string name;
+    std::string value;
+    while (p < end) {
+        char c = *p;
+        if (isSpace(c)) {
+            ++p;
+        } else if (c == '[') {
+            p = parseTag(p, end, name, value);
+            if (name == "FEN") {
+                if (!parseFen(value, game.start)) return fail(error, "bad FEN tag \"" + value + "\"");
+                pos = game.start;
+            }
+            if (name != "FEN" && name != "Result") game.tags.emplace_back(name, value);
+        } else if (c == '{' || c == '(') {
+            p = skipBlock(p, end);
+        } else if (c == ';' || c == '%') {
+            p = skipLine(p, end);
+        } else if (c == '$') {
+            for (++p; p < end && isDigit(*p); ++p) {}
+        } else {
+            const char* token = p;
+            while (p < end && !isSpace(*p) && *p != '{' && *p != '(' && *p != ';' && *p != '[') ++p;
+            size_t tokenLength = p - token;
+
+            if (const char* result = resultToken(token, tokenLength)) {
+                game.result = result;
+                return true;
+            }
+
+            // "12." and "12..." number the moves; they may be glued to the move.
+            const char* number = token;
+            while (number < p && isDigit(*number)) ++number;
+            if (number > token && number < p && *number == '.') {
+                while (number < p && *number == '.') ++number;
+                token = number;
+            }
+            const char* moveEnd = p;
+            while (moveEnd > token && std::strchr("!?+#*", moveEnd[-1])) --moveEnd;
+            if (moveEnd == token) continue;
+
+            Move move;
+            if (!parseMove(pos, token, moveEnd - token, move)) {
+                return fail(error, "illegal move \"" + std::string(token, moveEnd) + "\" at ply " +
+                                   std::to_string(game.moves.size() + 1));
+            }
+            game.moves.push_back(move);
+            makeMove(pos, move);
+        }
+    }
+    return true;
+}
+
+bool PdnDatabase::open(const std::string& path) {
+    return file.open(path);
+}
+
+size_t PdnDatabase::nextGameStart(size_t from) const {
+    const char* data = reinterpret_cast<const char*>(file.data());
+    size_t size = file.size();
+
+    size_t line = from;
+    if (line > 0 && line < size && data[line - 1] != '\n') line = skipLine(data + line, data + size) - data;
+
+    while (line < size) {
+        if (data[line] == '[') {
+            // A tag line opens a game unless the previous non-blank line is
+            // also a tag line.
+            size_t back = line;
+            while (back > 0 && isSpace(data[back - 1])) --back;
+            if (back == 0) return line;
+            size_t previous = back - 1;
+            while (previous > 0 && data[previous - 1] != '\n') --previous;
+            if (previous == 0) previous = skipBom(data, size);
+            if (data[previous] != '[') return line;
+        }
+        line = skipLine(data + line, data + size) - data;
+    }
+    return size;
+}
+
+bool PdnDatabase::parseGameAt(uint64_t offset, PdnGame& game, std::string* error) const {
+    if (offset >= file.size()) return fail(error, "offset past the end of the file");
+    size_t stop = nextGameStart(static_cast<size_t>(offset) + 1);
+    const char* data = reinterpret_cast<const char*>(file.data());
+    return parsePdnGame(data + offset, stop - offset, game, error);
+}
+
+PdnStats PdnDatabase::forEachGame(int threads, const PdnVisitor& visit) const {
+    PdnStats stats;
+    if (!file.isOpen()) return stats;
+
+    const char* data = reinterpret_cast<const char*>(file.data());
+    size_t size = file.size();
+    size_t chunks = (size + CHUNK_BYTES - 1) / CHUNK_BYTES;
+    std::atomic<size_t> nextChunk(0);
+    std::atomic<uint64_t> games(0);
+    std::atomic<uint64_t> invalidGames(0);
+    std::atomic<uint64_t> moves(0);
+    std::mutex errorMutex;
+
+    auto worker = [&](int id) {
+        PdnGame game;
+        std::string error;
+        for (size_t chunk = nextChunk++; chunk < chunks; chunk = nextChunk++) {
+            size_t begin = chunk * CHUNK_BYTES;
+            size_t end = std::min(size, begin + CHUNK_BYTES);
+
+            // A chunk owns the games that start inside it.
+            size_t start = chunk == 0 ? 0 : nextGameStart(begin);
+            while (start < end) {
+                size_t stop = nextGameStart(start + 1);
+                if (!parsePdnGame(data + start, stop - start, game, &error)) {
+                    ++invalidGames;
+                    std::lock_guard<std::mutex> lock(errorMutex);
+                    if (stats.firstError.empty() || start < stats.firstErrorOffset) {
+                        stats.firstError = error;
+                        stats.firstErrorOffset = start;
+                    }
+                } else if (!game.tags.empty() || !game.moves.empty()) {
+                    ++games;
+                    moves += game.moves.size();
+                    visit(id, start, game);
+                }
+                start = stop;
+            }
+        }
+    };
+
+    threads = std::max(1, threads);
+    std::vector<std::thread> pool;
+    for (int i = 1; i < threads; ++i) pool.emplace_back(worker, i);
+    worker(0);
+    for (auto& thread : pool) thread.join();
+
+    stats.games = games;
+    stats.invalidGames = invalidGames;
+    stats.moves = moves;
+    return stats;
+}
+
+bool PdnWriter::open(const std::string& path, bool append) {
+    offset = 0;
+    if (append) {
+        std::ifstream existing(path, std::ios::binary | std::ios::ate);
+        if (existing) offset = static_cast<uint64_t>(existing.tellg());
+    }
+    out.open(path, std::ios::binary | (append ? std::ios::app : std::ios::trunc));
+    return out.is_open();
+}
+
+uint64_t PdnWriter::write(const PdnGame& game) {
+    std::string text = formatPdn(game);
+    uint64_t start = offset;
+    out << text << std::flush;
+    offset += text.size();
+    return start;
+}
@@ -0,0 +1,81 @@
+#ifndef PDN_H
+#define PDN_H
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "bitboard.h"
+#include "mapped_file.h"
+
+// Portable Draughts Notation game record (GameType 25, Russian draughts).
+struct PdnGame {
+    std::vector<std::pair<std::string, std::string>> tags;
+    Position start = Position::initial();
+    std::vector<Move> moves;
+    std::string result = "*";    // "2-0", "0-2", "1-1" or "*"
+
+    std::string tag(const std::string& name) const;
+    void setTag(const std::string& name, const std::string& value);
+};
+
+std::string formatPdn(const PdnGame& game);
+
+// Parses one game from `text` (tag pairs, then movetext up to the result).
+// Every move is validated against the rules; on failure `error` says where.
+// Comments, variations and NAGs are skipped, "1-0"/"0-1"/"1/2-1/2" results
+// are normalized to the 2-point form.
+bool parsePdnGame(const char* text, size_t length, PdnGame& game, std::string* error = nullptr);
+
+struct PdnStats {
+    uint64_t games = 0;
+    uint64_t invalidGames = 0;
+    uint64_t moves = 0;
+    uint64_t firstErrorOffset = 0;
+    std::string firstError;
+};
+
+// Called from worker threads with the worker number (0..threads-1) and the
+// byte offset of the game in the file.
+typedef std::function<void(int worker, uint64_t offset, const PdnGame& game)> PdnVisitor;
+
+// Memory-mapped PDN collection. Games are parsed straight out of the mapping;
+// a game starts at a tag line that does not follow another tag line, so the
+// file can be cut anywhere and resynchronized on the next game.
+class PdnDatabase {
+public:
+    bool open(const std::string& path);
+    void close() { file.close(); }
+    bool isOpen() const { return file.isOpen(); }
+    uint64_t size() const { return file.size(); }
+
+    bool parseGameAt(uint64_t offset, PdnGame& game, std::string* error = nullptr) const;
+
+    // Splits the file into chunks cut at game boundaries and parses them on
+    // `threads` workers; invalid games are counted but not visited.
+    PdnStats forEachGame(int threads, const PdnVisitor& visit) const;
+
+private:
+    size_t nextGameStart(size_t from) const;
+
+    MappedFile file;
+};
+
+// Appends games to a PDN file and reports where each one starts, which is
+// the offset PdnDatabase and the position index use.
+class PdnWriter {
+public:
+    bool open(const std::string& path, bool append = false);
+    bool isOpen() const { return out.is_open(); }
+    uint64_t write(const PdnGame& game);
+
+private:
+    std::ofstream out;
+    uint64_t offset = 0;
+};
+
+#endif // PDN_H
@@ -0,0 +1,9 @@
+#include "perft.h"
+
+uint64_t perft(const Position& pos, int depth) {
+    return variantPerft<RussianDraughts>(pos, depth);
+}
+
+uint64_t perftParallel(const Position& pos, int depth, int threads, std::vector<PerftDivide>* divide) {
+    return variantPerftParallel<RussianDraughts>(pos, depth, threads, divide);
+}
@@ -0,0 +1,75 @@
+#ifndef PERFT_H
+#define PERFT_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "bitboard.h"
+#include "rules.h"
+
+template <typename MoveType>
+struct BasicPerftDivide {
+    MoveType move;
+    uint64_t nodes = 0;
+};
+
+typedef BasicPerftDivide<Move> PerftDivide;
+
+template <typename Variant>
+uint64_t variantPerft(const typename Variant::PositionType& pos, int depth) {
+    if (depth == 0) return 1;
+
+    typename Variant::MoveListType moves;
+    Variant::generateMoves(pos, moves);
+    if (depth == 1) return moves.size();
+
+    uint64_t nodes = 0;
+    for (const auto& move : moves) {
+        typename Variant::PositionType next = pos;
+        typename Variant::UndoType undo;
+        Variant::makeMove(next, move, undo);
+        nodes += variantPerft<Variant>(next, depth - 1);
+    }
+    return nodes;
+}
+
+// Splits the root moves across `threads` workers; `divide` receives the
+// per-root-move counts in move generation order.
+template <typename Variant>
+uint64_t variantPerftParallel(const typename Variant::PositionType& pos, int depth, int threads,
+                              std::vector<BasicPerftDivide<typename Variant::MoveType>>* divide = nullptr) {
+    typename Variant::MoveListType moves;
+    Variant::generateMoves(pos, moves);
+    if (depth == 0) return 1;
+
+    std::vector<BasicPerftDivide<typename Variant::MoveType>> results(moves.size());
+    std::atomic<size_t> nextMove(0);
+
+    auto worker = [&]() {
+        for (size_t i = nextMove++; i < moves.size(); i = nextMove++) {
+            typename Variant::PositionType next = pos;
+            typename Variant::UndoType undo;
+            Variant::makeMove(next, moves[i], undo);
+            results[i].move = moves[i];
+            results[i].nodes = variantPerft<Variant>(next, depth - 1);
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (int i = 1; i < threads; ++i) pool.emplace_back(worker);
+    worker();
+    for (auto& thread : pool) thread.join();
+
+    uint64_t total = 0;
+    for (const auto& result : results) total += result.nodes;
+    if (divide) *divide = results;
+    return total;
+}
+
+uint64_t perft(const Position& pos, int depth);
+uint64_t perftParallel(const Position& pos, int depth, int threads, std::vector<PerftDivide>* divide = nullptr);
+
+#endif // PERFT_H
@@ -0,0 +1,111 @@
+#include "position_index.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#include "game_state.h"
+
+namespace {
+
+const char MAGIC[4] = {'C', 'K', 'P', 'I'};
+const uint32_t VERSION = 1;
+
+struct IndexHeader {
+    char magic[4];
+    uint32_t version;
+    uint64_t entryCount;
+    uint64_t pdnSize;
+    uint64_t reserved;
+};
+static_assert(sizeof(IndexHeader) == 32, "position index header must be packed");
+static_assert(sizeof(PositionIndexEntry) == 16, "position index entries must be packed");
+
+bool entryLess(const PositionIndexEntry& a, const PositionIndexEntry& b) {
+    return a.key != b.key ? a.key < b.key : a.gameOffset < b.gameOffset;
+}
+
+bool entryEqual(const PositionIndexEntry& a, const PositionIndexEntry& b) {
+    return a.key == b.key && a.gameOffset == b.gameOffset;
+}
+
+} // namespace
+
+bool buildPositionIndex(const PdnDatabase& games, const std::string& path, int threads, PdnStats* stats) {
+    threads = std::max(1, threads);
+    std::vector<std::vector<PositionIndexEntry>> perWorker(threads);
+
+    PdnStats scanned = games.forEachGame(threads, [&](int worker, uint64_t offset, const PdnGame& game) {
+        std::vector<PositionIndexEntry>& out = perWorker[worker];
+        GameState state(game.start);
+        out.push_back(PositionIndexEntry{state.hash(), offset});
+        for (const auto& move : game.moves) {
+            state.makeMove(move);
+            out.push_back(PositionIndexEntry{state.hash(), offset});
+        }
+    });
+    if (stats) *stats = scanned;
+
+    std::vector<PositionIndexEntry> entries;
+    size_t total = 0;
+    for (const auto& part : perWorker) total += part.size();
+    entries.reserve(total);
+    for (auto& part : perWorker) {
+        entries.insert(entries.end(), part.begin(), part.end());
+        std::vector<PositionIndexEntry>().swap(part);
+    }
+
+    // Repetitions put the same (key, game) pair in more than once.
+    std::sort(entries.begin(), entries.end(), entryLess);
+    entries.erase(std::unique(entries.begin(), entries.end(), entryEqual), entries.end());
+
+    IndexHeader header = {};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.entryCount = entries.size();
+    header.pdnSize = games.size();
+
+    FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) return false;
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+              std::fwrite(entries.data(), sizeof(PositionIndexEntry), entries.size(), file) == entries.size();
+    return std::fclose(file) == 0 && ok;
+}
+
+bool PositionIndex::open(const std::string& path) {
+    close();
+    if (!file.open(path) || file.size() < sizeof(IndexHeader)) {
+        file.close();
+        return false;
+    }
+
+    IndexHeader header;
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION ||
+        file.size() != sizeof(header) + header.entryCount * sizeof(PositionIndexEntry)) {
+        file.close();
+        return false;
+    }
+
+    entries = reinterpret_cast<const PositionIndexEntry*>(file.data() + sizeof(header));
+    count = header.entryCount;
+    pdnSize = header.pdnSize;
+    return true;
+}
+
+void PositionIndex::close() {
+    file.close();
+    entries = nullptr;
+    count = 0;
+    pdnSize = 0;
+}
+
+void PositionIndex::find(uint64_t key, std::vector<uint64_t>& gameOffsets) const {
+    gameOffsets.clear();
+    if (!entries) return;
+
+    const PositionIndexEntry* end = entries + count;
+    const PositionIndexEntry* it = std::lower_bound(entries, end, key,
+        [](const PositionIndexEntry& entry, uint64_t value) { return entry.key < value; });
+    for (; it != end && it->key == key; ++it) gameOffsets.push_back(it->gameOffset);
+}
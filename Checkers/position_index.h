@@ -0,0 +1,43 @@
+#ifndef POSITION_INDEX_H
+#define POSITION_INDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "mapped_file.h"
+#include "pdn.h"
+
+// On-disk map from Zobrist key to the offsets of the games in a PDN file that
+// reach the position. The file is a 32-byte header followed by (key, offset)
+// pairs sorted by key, so a lookup is a binary search over the mapping.
+struct PositionIndexEntry {
+    uint64_t key;
+    uint64_t gameOffset;
+};
+
+// Indexes every position of every valid game, the start position included.
+bool buildPositionIndex(const PdnDatabase& games, const std::string& path, int threads, PdnStats* stats = nullptr);
+
+class PositionIndex {
+public:
+    bool open(const std::string& path);
+    void close();
+    bool isOpen() const { return entries != nullptr; }
+
+    uint64_t entryCount() const { return count; }
+    // Size of the PDN file the index was built from, to detect stale indexes.
+    uint64_t sourceSize() const { return pdnSize; }
+
+    // Offsets of the games reaching `key`, in file order.
+    void find(uint64_t key, std::vector<uint64_t>& gameOffsets) const;
+
+private:
+    MappedFile file;
+    const PositionIndexEntry* entries = nullptr;
+    uint64_t count = 0;
+    uint64_t pdnSize = 0;
+};
+
+#endif // POSITION_INDEX_H
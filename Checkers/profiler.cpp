@@ -0,0 +1,262 @@
+#include "profiler.h"
+
+#ifdef CHECKERS_PROFILE
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+struct ZoneEvent {
+    uint64_t start;
+    uint64_t duration;
+    int id;
+};
+
+// Written by its own thread only; the exporter reads it concurrently, hence
+// the atomics, which are updated with plain relaxed loads and stores.
+struct ThreadLog {
+    int index = 0;
+    std::unique_ptr<ZoneEvent[]> ring{new ZoneEvent[PROFILE_RING_EVENTS]};
+    std::atomic<uint64_t> written{0};
+    std::atomic<uint64_t> calls[MAX_PROFILE_NAMES] = {};
+    std::atomic<uint64_t> totalNs[MAX_PROFILE_NAMES] = {};
+    std::atomic<int64_t> counters[MAX_PROFILE_NAMES] = {};
+};
+
+// Thread logs outlive their threads so that a trace taken at exit still
+// shows the search helpers. A finished thread's log goes on `freeLogs` and
+// carries on as the log of the next new thread, so searches that start
+// fresh helpers every time do not grow the registry.
+struct Registry {
+    std::mutex mutex;
+    const char* names[MAX_PROFILE_NAMES] = {};
+    ProfileKind kinds[MAX_PROFILE_NAMES] = {};
+    std::atomic<int> nameCount{0};
+    std::vector<std::unique_ptr<ThreadLog>> threads;
+    std::vector<ThreadLog*> freeLogs;
+    uint64_t epoch = profileNow();
+};
+
+Registry& registry() {
+    static Registry instance;
+    return instance;
+}
+
+// Returns the thread's log to the free list when the thread exits.
+struct LogHolder {
+    ThreadLog* log = nullptr;
+
+    ~LogHolder() {
+        if (!log) return;
+        Registry& reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        reg.freeLogs.push_back(log);
+    }
+};
+
+thread_local LogHolder currentLog;
+
+ThreadLog& threadLog() {
+    if (!currentLog.log) {
+        Registry& reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        if (!reg.freeLogs.empty()) {
+            currentLog.log = reg.freeLogs.back();
+            reg.freeLogs.pop_back();
+        } else {
+            reg.threads.emplace_back(new ThreadLog());
+            currentLog.log = reg.threads.back().get();
+            currentLog.log->index = static_cast<int>(reg.threads.size());
+        }
+    }
+    return *currentLog.log;
+}
+
+template <typename T>
+void add(std::atomic<T>& value, T delta) {
+    value.store(value.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+}
+
+struct Snapshot {
+    int names = 0;
+    std::vector<std::vector<ZoneEvent>> events;     // per thread, oldest first
+    std::vector<uint64_t> calls;
+    std::vector<uint64_t> totalNs;
+    std::vector<int64_t> counters;
+};
+
+Snapshot takeSnapshot() {
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    Snapshot snap;
+    snap.names = reg.nameCount;
+    snap.calls.assign(snap.names, 0);
+    snap.totalNs.assign(snap.names, 0);
+    snap.counters.assign(snap.names, 0);
+
+    for (const auto& log : reg.threads) {
+        uint64_t written = log->written.load(std::memory_order_acquire);
+        uint64_t first = written > PROFILE_RING_EVENTS ? written - PROFILE_RING_EVENTS : 0;
+        std::vector<ZoneEvent> events;
+        events.reserve(written - first);
+        for (uint64_t i = first; i < written; ++i) events.push_back(log->ring[i & (PROFILE_RING_EVENTS - 1)]);
+        snap.events.push_back(std::move(events));
+
+        for (int id = 0; id < snap.names; ++id) {
+            snap.calls[id] += log->calls[id].load(std::memory_order_relaxed);
+            snap.totalNs[id] += log->totalNs[id].load(std::memory_order_relaxed);
+            snap.counters[id] += log->counters[id].load(std::memory_order_relaxed);
+        }
+    }
+    return snap;
+}
+
+std::string jsonString(const char* text) {
+    std::string out = "\"";
+    for (const char* c = text; *c; ++c) {
+        if (*c == '"' || *c == '\\') out += '\\';
+        out += *c;
+    }
+    return out + "\"";
+}
+
+double percentile(const std::vector<uint64_t>& sorted, double fraction) {
+    if (sorted.empty()) return 0;
+    size_t index = std::min(sorted.size() - 1, static_cast<size_t>(sorted.size() * fraction));
+    return static_cast<double>(sorted[index]);
+}
+
+} // namespace
+
+bool profilingEnabled() {
+    return true;
+}
+
+// The last slot is shared by every name beyond the table's capacity.
+int profileRegister(const char* name, ProfileKind kind) {
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    int count = reg.nameCount;
+    for (int id = 0; id < count; ++id) {
+        if (reg.kinds[id] == kind && std::strcmp(reg.names[id], name) == 0) return id;
+    }
+    if (count == MAX_PROFILE_NAMES) return MAX_PROFILE_NAMES - 1;
+
+    reg.names[count] = count == MAX_PROFILE_NAMES - 1 ? "(other)" : name;
+    reg.kinds[count] = kind;
+    reg.nameCount = count + 1;
+    return count;
+}
+
+void profileRecord(int id, uint64_t startNs, uint64_t endNs) {
+    ThreadLog& log = threadLog();
+    uint64_t slot = log.written.load(std::memory_order_relaxed);
+    log.ring[slot & (PROFILE_RING_EVENTS - 1)] = ZoneEvent{startNs, endNs - startNs, id};
+    log.written.store(slot + 1, std::memory_order_release);
+    add<uint64_t>(log.calls[id], 1);
+    add<uint64_t>(log.totalNs[id], endNs - startNs);
+}
+
+void profileCount(int id, int64_t delta) {
+    add<int64_t>(threadLog().counters[id], delta);
+}
+
+bool writeChromeTrace(const std::string& path) {
+    FILE* file = std::fopen(path.c_str(), "w");
+    if (!file) return false;
+
+    Snapshot snap = takeSnapshot();
+    Registry& reg = registry();
+    uint64_t lastUs = 0;
+
+    std::fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    std::fprintf(file, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"checkers\"}}");
+    for (size_t thread = 0; thread < snap.events.size(); ++thread) {
+        int tid = static_cast<int>(thread) + 1;
+        std::fprintf(file, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"thread %d\"}}",
+                     tid, tid);
+        for (const auto& event : snap.events[thread]) {
+            uint64_t start = event.start > reg.epoch ? event.start - reg.epoch : 0;
+            lastUs = std::max(lastUs, (start + event.duration) / 1000);
+            std::fprintf(file, ",\n{\"name\":%s,\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                         jsonString(reg.names[event.id]).c_str(), tid, start / 1000.0, event.duration / 1000.0);
+        }
+    }
+    for (int id = 0; id < snap.names; ++id) {
+        if (reg.kinds[id] != ProfileKind::Counter) continue;
+        std::fprintf(file, ",\n{\"name\":%s,\"ph\":\"C\",\"pid\":1,\"ts\":%llu,\"args\":{\"value\":%lld}}",
+                     jsonString(reg.names[id]).c_str(), static_cast<unsigned long long>(lastUs),
+                     static_cast<long long>(snap.counters[id]));
+    }
+    std::fprintf(file, "\n]}\n");
+    return std::fclose(file) == 0;
+}
+
+std::string profileSummary() {
+    Snapshot snap = takeSnapshot();
+    Registry& reg = registry();
+
+    std::vector<std::vector<uint64_t>> durations(snap.names);
+    for (const auto& events : snap.events) {
+        for (const auto& event : events) durations[event.id].push_back(event.duration);
+    }
+
+    std::string out;
+    char line[160];
+    std::snprintf(line, sizeof(line), "%-28s %10s %12s %10s %10s %10s\n", "zone", "calls", "total ms", "mean us",
+                  "p50 us", "p99 us");
+    out += line;
+    for (int id = 0; id < snap.names; ++id) {
+        if (reg.kinds[id] != ProfileKind::Zone || snap.calls[id] == 0) continue;
+        std::vector<uint64_t>& sorted = durations[id];
+        std::sort(sorted.begin(), sorted.end());
+        std::snprintf(line, sizeof(line), "%-28s %10llu %12.2f %10.1f %10.1f %10.1f\n", reg.names[id],
+                      static_cast<unsigned long long>(snap.calls[id]), snap.totalNs[id] / 1e6,
+                      snap.totalNs[id] / 1e3 / snap.calls[id], percentile(sorted, 0.5) / 1e3,
+                      percentile(sorted, 0.99) / 1e3);
+        out += line;
+    }
+
+    bool header = false;
+    for (int id = 0; id < snap.names; ++id) {
+        if (reg.kinds[id] != ProfileKind::Counter) continue;
+        if (!header) {
+            std::snprintf(line, sizeof(line), "%-28s %16s\n", "counter", "total");
+            out += line;
+            header = true;
+        }
+        std::snprintf(line, sizeof(line), "%-28s %16lld\n", reg.names[id], static_cast<long long>(snap.counters[id]));
+        out += line;
+    }
+    return out;
+}
+
+#else
+
+bool profilingEnabled() {
+    return false;
+}
+
+int profileRegister(const char*, ProfileKind) {
+    return 0;
+}
+
+void profileRecord(int, uint64_t, uint64_t) {}
+
+void profileCount(int, int64_t) {}
+
+bool writeChromeTrace(const std::string&) {
+    return false;
+}
+
+std::string profileSummary() {
+    return "profiling is compiled out; configure with -DCHECKERS_PROFILE=ON\n";
+}
+
+#endif
@@ -0,0 +1,73 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+// Scoped zone timers and counters for live sessions and engine runs. Every
+// thread records into its own ring buffer, so instrumented code never takes a
+// lock; the latest PROFILE_RING_EVENTS zones per thread are kept for the
+// trace and the percentiles, while call counts and counter totals are exact.
+// Without CHECKERS_PROFILE (the CMake option of the same name) the macros
+// expand to nothing and the export functions report that profiling is off.
+//
+//   PROFILE_ZONE("render");            // times the enclosing scope
+//   PROFILE_COUNTER("nodes", batch);   // adds to a per-thread total
+
+const int PROFILE_RING_EVENTS = 1 << 16;
+const int MAX_PROFILE_NAMES = 256;
+
+enum class ProfileKind { Zone, Counter };
+
+bool profilingEnabled();
+
+// Returns a stable id for a string literal; call sites cache it in a static.
+int profileRegister(const char* name, ProfileKind kind);
+
+inline uint64_t profileNow() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void profileRecord(int id, uint64_t startNs, uint64_t endNs);
+void profileCount(int id, int64_t delta);
+
+class ProfileZone {
+public:
+    explicit ProfileZone(int id) : id(id), start(profileNow()) {}
+    ~ProfileZone() { profileRecord(id, start, profileNow()); }
+
+    ProfileZone(const ProfileZone&) = delete;
+    ProfileZone& operator=(const ProfileZone&) = delete;
+
+private:
+    int id;
+    uint64_t start;
+};
+
+// Chrome trace-event JSON (chrome://tracing, Perfetto) of the buffered zones
+// plus the counter totals. Meant to be called once the instrumented threads
+// are idle; zones recorded meanwhile may be missing or torn.
+bool writeChromeTrace(const std::string& path);
+
+// Per-zone calls, total time and p50/p99 durations, then counter totals.
+std::string profileSummary();
+
+#ifdef CHECKERS_PROFILE
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_ZONE(name)                                                                                  \
+    static const int PROFILE_CONCAT(profileZoneId, __LINE__) = profileRegister(name, ProfileKind::Zone);   \
+    ProfileZone PROFILE_CONCAT(profileZone, __LINE__)(PROFILE_CONCAT(profileZoneId, __LINE__))
+#define PROFILE_COUNTER(name, delta)                                                   \
+    do {                                                                               \
+        static const int profileCounterId = profileRegister(name, ProfileKind::Counter); \
+        profileCount(profileCounterId, delta);                                         \
+    } while (0)
+#else
+#define PROFILE_ZONE(name) ((void)0)
+#define PROFILE_COUNTER(name, delta) ((void)0)
+#endif
+
+#endif // PROFILER_H
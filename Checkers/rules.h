@@ -0,0 +1,385 @@
+#ifndef RULES_H
+#define RULES_H
+
+#include <algorithm>
+
+#include "bitboard.h"
+
+// Rule-set policies. Every difference between the variants is a compile-time
+// constant, so each RuleSet instantiation is generated without the branches
+// of the rules it does not play.
+
+enum class CrownRule {
+    ContinueAsKing,     // a man reaching the last row mid-capture goes on as a king
+    ContinueAsMan,      // ... goes on as a man, crowned only if the move ends there
+    EndMove             // ... is crowned and the move ends
+};
+
+struct RussianRules {
+    static constexpr bool FLYING_KINGS = true;
+    static constexpr bool MEN_CAPTURE_BACKWARD = true;
+    static constexpr bool MAXIMUM_CAPTURE = false;   // any capture sequence may be chosen
+    static constexpr CrownRule CROWN = CrownRule::ContinueAsKing;
+};
+
+struct InternationalRules {
+    static constexpr bool FLYING_KINGS = true;
+    static constexpr bool MEN_CAPTURE_BACKWARD = true;
+    static constexpr bool MAXIMUM_CAPTURE = true;    // must take the most pieces
+    static constexpr CrownRule CROWN = CrownRule::ContinueAsMan;
+};
+
+// English draughts / American checkers.
+struct EnglishRules {
+    static constexpr bool FLYING_KINGS = false;
+    static constexpr bool MEN_CAPTURE_BACKWARD = false;
+    static constexpr bool MAXIMUM_CAPTURE = false;
+    static constexpr CrownRule CROWN = CrownRule::EndMove;
+};
+
+// Move generation and make/unmake for one geometry and rule set; the Russian
+// 8x8 instantiation is what the free functions of bitboard.h run. Quiet moves
+// and capture detection work on whole bitboards, capture sequences walk the
+// geometry's neighbor and ray tables. Moves come out in the same order for
+// every instantiation: captures by origin square, direction and distance,
+// then men's steps by direction and target, then kings' moves by origin.
+template <typename Geometry, typename Rules>
+class RuleSet {
+public:
+    typedef Geometry GeometryType;
+    typedef typename Geometry::Mask Mask;
+    typedef BasicPosition<Geometry> PositionType;
+    typedef BasicMove<Geometry> MoveType;
+    typedef BasicMoveList<MoveType> MoveListType;
+    typedef BasicUndoInfo<Geometry> UndoType;
+
+    // Pieces of the side to move that have at least one capture available.
+    static Mask capturers(const PositionType& pos);
+    // Pieces of the side to move that have a quiet step.
+    static Mask movers(const PositionType& pos);
+
+    static void generateMoves(const PositionType& pos, MoveListType& moves) {
+        generateMoves(pos, capturers(pos), moves);
+    }
+    static void generateMoves(const PositionType& pos, Mask jumpers, MoveListType& moves);
+
+    static void makeMove(PositionType& pos, const MoveType& move, UndoType& undo);
+    static void unmakeMove(PositionType& pos, const MoveType& move, const UndoType& undo);
+
+private:
+    struct CaptureContext {
+        Mask empty;     // origin square counts as empty while the piece travels
+        Mask enemy;
+        Mask crown;
+        PieceColor side;
+        MoveType current;
+        MoveListType& moves;
+    };
+
+    static Mask promotionRow(PieceColor color) {
+        return color == PieceColor::White ? Geometry::WHITE_PROMOTION : Geometry::BLACK_PROMOTION;
+    }
+
+    static bool isForward(PieceColor color, int dir) {
+        return color == PieceColor::White ? dir == DownRight || dir == DownLeft : dir == UpRight || dir == UpLeft;
+    }
+
+    // The hot paths name their direction at compile time so every shift is
+    // a fixed pair of masks and shifts rather than a switch.
+    template <int Dir>
+    static Mask pieceCapturers(Mask pieces, Mask empty, Mask enemy) {
+        constexpr int back = oppositeDirection(Dir);
+        return pieces & Geometry::template shift<back>(enemy & Geometry::template shift<back>(empty));
+    }
+
+    template <int Dir>
+    static Mask directionCapturers(PieceColor side, Mask men, Mask kings, Mask empty, Mask enemy) {
+        Mask pieces = men;
+        if constexpr (!Rules::MEN_CAPTURE_BACKWARD) {
+            if (!isForward(side, Dir)) pieces = 0;
+        }
+        if constexpr (!Rules::FLYING_KINGS) pieces |= kings;
+        return pieceCapturers<Dir>(pieces, empty, enemy);
+    }
+
+    template <int Dir>
+    static void addManSteps(Mask men, Mask empty, Mask crown, MoveListType& moves) {
+        constexpr int back = oppositeDirection(Dir);
+        Mask targets = Geometry::template shift<Dir>(men) & empty;
+        while (targets) {
+            int to = popLowest(targets);
+            MoveType move;
+            move.from = static_cast<uint8_t>(Geometry::NEIGHBORS[to][back]);
+            move.to = static_cast<uint8_t>(to);
+            move.path[0] = move.to;
+            move.pathLength = 1;
+            move.promotion = (Geometry::bit(to) & crown) != 0;
+            moves.push_back(move);
+        }
+    }
+
+    static Mask flyingKingCapturers(Mask kings, Mask empty, Mask enemy);
+    static void addUnique(MoveListType& moves, const MoveType& move);
+    static void finishCapture(CaptureContext& ctx, int sq, bool king);
+    static void findCaptures(CaptureContext& ctx, int sq, bool king);
+    static bool kingCanCapture(const CaptureContext& ctx, int sq, Mask captured);
+    static void tryLanding(CaptureContext& ctx, int victim, int landing, bool king);
+    static void keepLongestCaptures(MoveListType& moves);
+};
+
+typedef RuleSet<BoardGeometry<8>, RussianRules> RussianDraughts;
+typedef RuleSet<BoardGeometry<10>, InternationalRules> InternationalDraughts;
+typedef RuleSet<BoardGeometry<8>, EnglishRules> EnglishDraughts;
+
+template <typename Geometry, typename Rules>
+typename Geometry::Mask RuleSet<Geometry, Rules>::flyingKingCapturers(Mask kings, Mask empty, Mask enemy) {
+    Mask blockers = ~empty & Geometry::BOARD;
+    Mask result = 0;
+    while (kings) {
+        int sq = popLowest(kings);
+        for (int dir = 0; dir < 4; ++dir) {
+            Mask ray = Geometry::RAYS[sq][dir] & blockers;
+            if (!ray) continue;
+            int target = Geometry::nearest(ray, dir);
+            int landing = Geometry::NEIGHBORS[target][dir];
+            if ((enemy & Geometry::bit(target)) && landing >= 0 && (empty & Geometry::bit(landing))) {
+                result |= Geometry::bit(sq);
+                break;
+            }
+        }
+    }
+    return result;
+}
+
+template <typename Geometry, typename Rules>
+typename Geometry::Mask RuleSet<Geometry, Rules>::capturers(const PositionType& pos) {
+    Mask empty = pos.empty();
+    Mask enemy = pos.enemy();
+    Mask kings = pos.own() & pos.kings;
+    Mask men = pos.own() & ~pos.kings;
+    PieceColor side = pos.sideToMove;
+    Mask result = directionCapturers<DownRight>(side, men, kings, empty, enemy) |
+                  directionCapturers<DownLeft>(side, men, kings, empty, enemy) |
+                  directionCapturers<UpRight>(side, men, kings, empty, enemy) |
+                  directionCapturers<UpLeft>(side, men, kings, empty, enemy);
+    if constexpr (Rules::FLYING_KINGS) result |= flyingKingCapturers(kings, empty, enemy);
+    return result;
+}
+
+template <typename Geometry, typename Rules>
+typename Geometry::Mask RuleSet<Geometry, Rules>::movers(const PositionType& pos) {
+    Mask empty = pos.empty();
+    Mask own = pos.own();
+    Mask kingSteps = Geometry::template shift<DownRight>(empty) | Geometry::template shift<DownLeft>(empty) |
+                     Geometry::template shift<UpRight>(empty) | Geometry::template shift<UpLeft>(empty);
+    // A man steps forward, so it needs an empty square in front of it.
+    Mask manSteps = pos.sideToMove == PieceColor::White ?
+                    Geometry::template shift<UpRight>(empty) | Geometry::template shift<UpLeft>(empty) :
+                    Geometry::template shift<DownRight>(empty) | Geometry::template shift<DownLeft>(empty);
+    return (own & pos.kings & kingSteps) | (own & ~pos.kings & manSteps);
+}
+
+template <typename Geometry, typename Rules>
+void RuleSet<Geometry, Rules>::addUnique(MoveListType& moves, const MoveType& move) {
+    for (const auto& other : moves) {
+        if (other.from == move.from && other.to == move.to && other.captured == move.captured) {
+            return;
+        }
+    }
+    moves.push_back(move);
+}
+
+template <typename Geometry, typename Rules>
+void RuleSet<Geometry, Rules>::finishCapture(CaptureContext& ctx, int sq, bool king) {
+    if constexpr (Rules::CROWN == CrownRule::ContinueAsMan) {
+        ctx.current.promotion = !king && (Geometry::bit(sq) & ctx.crown);
+    }
+    addUnique(ctx.moves, ctx.current);
+}
+
+template <typename Geometry, typename Rules>
+void RuleSet<Geometry, Rules>::tryLanding(CaptureContext& ctx, int victim, int landing, bool king) {
+    MoveType saved = ctx.current;
+    ctx.current.captured |= Geometry::bit(victim);
+    ctx.current.path[ctx.current.pathLength++] = static_cast<uint8_t>(landing);
+    ctx.current.to = static_cast<uint8_t>(landing);
+
+    bool crowned = !king && (Geometry::bit(landing) & ctx.crown);
+    if constexpr (Rules::CROWN == CrownRule::ContinueAsKing) {
+        if (crowned) ctx.current.promotion = true;
+        findCaptures(ctx, landing, king || crowned);
+    } else if constexpr (Rules::CROWN == CrownRule::EndMove) {
+        if (crowned) {
+            ctx.current.promotion = true;
+            addUnique(ctx.moves, ctx.current);
+        } else {
+            findCaptures(ctx, landing, king);
+        }
+    } else {
+        findCaptures(ctx, landing, king);
+    }
+    ctx.current = saved;
+}
+
+template <typename Geometry, typename Rules>
+void RuleSet<Geometry, Rules>::findCaptures(CaptureContext& ctx, int sq, bool king) {
+    bool extended = false;
+    Mask victims = ctx.enemy & ~ctx.current.captured;
+    Mask blockers = ~ctx.empty & Geometry::BOARD;
+
+    for (int dir = 0; dir < 4; ++dir) {
+        int target;
+        if (Rules::FLYING_KINGS && king) {
+            Mask ray = Geometry::RAYS[sq][dir] & blockers;
+            if (!ray) continue;
+            target = Geometry::nearest(ray, dir);
+        } else {
+            if constexpr (!Rules::MEN_CAPTURE_BACKWARD) {
+                if (!king && !isForward(ctx.side, dir)) continue;
+            }
+            target = Geometry::NEIGHBORS[sq][dir];
+            if (target < 0) continue;
+        }
+        if (!(victims & Geometry::bit(target))) continue;
+
+        int first = Geometry::NEIGHBORS[target][dir];
+        if (first < 0 || !(ctx.empty & Geometry::bit(first))) continue;
+        extended = true;
+        if (!Rules::FLYING_KINGS || !king) {
+            tryLanding(ctx, target, first, king);
+            continue;
+        }
+
+        // A flying king has to stop where the capture goes on if there is
+        // such a square; only when there is none may it stop anywhere.
+        Mask captured = ctx.current.captured | Geometry::bit(target);
+        Mask landings = 0;
+        Mask continuing = 0;
+        for (int landing = first; landing >= 0 && (ctx.empty & Geometry::bit(landing));
+             landing = Geometry::NEIGHBORS[landing][dir]) {
+            landings |= Geometry::bit(landing);
+            if (kingCanCapture(ctx, landing, captured)) continuing |= Geometry::bit(landing);
+        }
+        if (continuing) landings = continuing;
+        for (int landing = first; landing >= 0 && (ctx.empty & Geometry::bit(landing));
+             landing = Geometry::NEIGHBORS[landing][dir]) {
+            if (landings & Geometry::bit(landing)) tryLanding(ctx, target, landing, king);
+        }
+    }
+
+    if (!extended && ctx.current.pathLength > 0) finishCapture(ctx, sq, king);
+}
+
+// Whether a king on `sq` has a further capture once the pieces in `captured`
+// are taken; they stay on the board until the move ends, so they block.
+template <typename Geometry, typename Rules>
+bool RuleSet<Geometry, Rules>::kingCanCapture(const CaptureContext& ctx, int sq, Mask captured) {
+    Mask victims = ctx.enemy & ~captured;
+    Mask blockers = ~ctx.empty & Geometry::BOARD;
+    for (int dir = 0; dir < 4; ++dir) {
+        Mask ray = Geometry::RAYS[sq][dir] & blockers;
+        if (!ray) continue;
+        int target = Geometry::nearest(ray, dir);
+        int landing = Geometry::NEIGHBORS[target][dir];
+        if ((victims & Geometry::bit(target)) && landing >= 0 && (ctx.empty & Geometry::bit(landing))) return true;
+    }
+    return false;
+}
+
+template <typename Geometry, typename Rules>
+void RuleSet<Geometry, Rules>::keepLongestCaptures(MoveListType& moves) {
+    int longest = 0;
+    for (const auto& move : moves) longest = std::max(longest, popCount(move.captured));
+    MoveListType kept;
+    for (const auto& move : moves) {
+        if (popCount(move.captured) == longest) kept.push_back(move);
+    }
+    moves = kept;
+}
+
+template <typename Geometry, typename Rules>
+void RuleSet<Geometry, Rules>::generateMoves(const PositionType& pos, Mask jumpers, MoveListType& moves) {
+    moves.clear();
+    Mask own = pos.own();
+    Mask crown = promotionRow(pos.sideToMove);
+
+    if (jumpers) {
+        while (jumpers) {
+            int sq = popLowest(jumpers);
+            CaptureContext ctx{pos.empty() | Geometry::bit(sq), pos.enemy(), crown, pos.sideToMove, MoveType(), moves};
+            ctx.current.from = static_cast<uint8_t>(sq);
+            findCaptures(ctx, sq, (pos.kings & Geometry::bit(sq)) != 0);
+        }
+        if constexpr (Rules::MAXIMUM_CAPTURE) keepLongestCaptures(moves);
+        return;
+    }
+
+    Mask empty = pos.empty();
+    Mask men = own & ~pos.kings;
+    if (pos.sideToMove == PieceColor::White) {
+        addManSteps<DownRight>(men, empty, crown, moves);
+        addManSteps<DownLeft>(men, empty, crown, moves);
+    } else {
+        addManSteps<UpRight>(men, empty, crown, moves);
+        addManSteps<UpLeft>(men, empty, crown, moves);
+    }
+
+    Mask kings = own & pos.kings;
+    while (kings) {
+        int sq = popLowest(kings);
+        for (int dir = 0; dir < 4; ++dir) {
+            for (int to = Geometry::NEIGHBORS[sq][dir]; to >= 0 && (empty & Geometry::bit(to));
+                 to = Geometry::NEIGHBORS[to][dir]) {
+                MoveType move;
+                move.from = static_cast<uint8_t>(sq);
+                move.to = static_cast<uint8_t>(to);
+                move.path[0] = move.to;
+                move.pathLength = 1;
+                moves.push_back(move);
+                if constexpr (!Rules::FLYING_KINGS) break;
+            }
+        }
+    }
+}
+
+template <typename Geometry, typename Rules>
+void RuleSet<Geometry, Rules>::makeMove(PositionType& pos, const MoveType& move, UndoType& undo) {
+    Mask from = Geometry::bit(move.from);
+    Mask to = Geometry::bit(move.to);
+    bool king = (pos.kings & from) != 0;
+    undo.wasKing = king;
+    undo.capturedKings = pos.kings & move.captured;
+
+    if (pos.sideToMove == PieceColor::White) {
+        pos.white = (pos.white & ~from) | to;
+        pos.black &= ~move.captured;
+    } else {
+        pos.black = (pos.black & ~from) | to;
+        pos.white &= ~move.captured;
+    }
+
+    pos.kings &= ~(move.captured | from);
+    if (king || move.promotion) pos.kings |= to;
+    pos.sideToMove = opponent(pos.sideToMove);
+}
+
+template <typename Geometry, typename Rules>
+void RuleSet<Geometry, Rules>::unmakeMove(PositionType& pos, const MoveType& move, const UndoType& undo) {
+    Mask from = Geometry::bit(move.from);
+    Mask to = Geometry::bit(move.to);
+    pos.sideToMove = opponent(pos.sideToMove);
+
+    // A king's capture may end on its origin square, so clear `to` first.
+    if (pos.sideToMove == PieceColor::White) {
+        pos.white = (pos.white & ~to) | from;
+        pos.black |= move.captured;
+    } else {
+        pos.black = (pos.black & ~to) | from;
+        pos.white |= move.captured;
+    }
+
+    pos.kings = (pos.kings & ~to) | undo.capturedKings;
+    if (undo.wasKing) pos.kings |= from;
+}
+
+#endif // RULES_H
@@ -0,0 +1,401 @@
+#include "search.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <thread>
+
+#include "eval.h"
+#include "game_state.h"
+#include "profiler.h"
+#include "tablebase.h"
+#include "zobrist.h"
+
+namespace {
+
+const int INFINITE_SCORE = MATE_SCORE + 1;
+const int HISTORY_LIMIT = 1 << 16;
+const uint64_t NODE_BATCH = 1024;
+
+bool sameMove(const Move& a, const Move& b) {
+    return a.from == b.from && a.to == b.to && a.captured == b.captured;
+}
+
+// Mate scores are stored relative to the node so they stay valid when the
+// same position is reached at a different ply.
+int scoreToTT(int score, int ply) {
+    if (score > MATE_BOUND) return score + ply;
+    if (score < -MATE_BOUND) return score - ply;
+    return score;
+}
+
+int scoreFromTT(int score, int ply) {
+    if (score > MATE_BOUND) return score - ply;
+    if (score < -MATE_BOUND) return score + ply;
+    return score;
+}
+
+} // namespace
+
+class SearchWorker {
+public:
+    SearchWorker(Engine& engine, int id) : engine(engine), id(id) {}
+
+    void clearHistory() {
+        for (auto& row : history) std::fill(std::begin(row), std::end(row), 0);
+    }
+
+    // Iterative deepening; only the main worker (id 0) enforces limits and
+    // reports, helpers keep deepening until the main worker aborts the search.
+    void iterate(const Position& pos, SearchResult& result, const SearchCallback& onIteration);
+
+private:
+    int alphaBeta(int alpha, int beta, int depth, int ply);
+    int quiescence(int alpha, int beta, int ply);
+    void orderMoves(const MoveList& moves, int ply, int ttMove, uint8_t* order);
+    void updateQuietStats(const Move& move, int depth, int ply);
+    bool isRepetition(uint64_t key, int ply) const;
+    void countNode();
+    std::vector<Move> extractPv(const Position& pos, int maxLength);
+
+    Engine& engine;
+    int id;
+    GameState state;
+    MoveList moveStack[MAX_PLY];
+    uint64_t keyStack[MAX_PLY] = {};
+    // Plies back to the last capture or man move, reaching into the game
+    // history when the line from the root has none.
+    int reversibleStack[MAX_PLY] = {};
+    Move killers[MAX_PLY][2];
+    int history[NUM_SQUARES][NUM_SQUARES] = {};
+
+    bool stopped = false;
+    int iterationDepth = 0;
+    uint64_t pendingNodes = 0;
+    Move rootBest;
+};
+
+void SearchWorker::iterate(const Position& pos, SearchResult& result, const SearchCallback& onIteration) {
+    stopped = false;
+    pendingNodes = 0;
+    state.reset(pos);
+    reversibleStack[0] = std::max(0, static_cast<int>(engine.gameHistory.size()) - 1);
+    for (auto& pair : killers) pair[0] = pair[1] = Move();
+    for (auto& row : history) {
+        for (auto& value : row) value /= 2;
+    }
+
+    // Odd helpers start one ply deeper so the threads spread over depths.
+    int firstDepth = 1 + (id & 1);
+    for (iterationDepth = firstDepth; iterationDepth <= engine.limits.depth; ++iterationDepth) {
+        PROFILE_ZONE("SearchWorker::iteration");
+        int score = alphaBeta(-INFINITE_SCORE, INFINITE_SCORE, iterationDepth, 0);
+        if (stopped) break;
+        if (id != 0) continue;
+
+        result.bestMove = rootBest;
+        result.score = score;
+        result.depth = iterationDepth;
+        result.nodes = engine.totalNodes + pendingNodes;
+        result.seconds = engine.elapsedSeconds();
+        result.pv = extractPv(pos, iterationDepth);
+        if (result.pv.empty() || !sameMove(result.pv.front(), rootBest)) {
+            result.pv.assign(1, rootBest);
+        }
+        if (onIteration) onIteration(result);
+
+        if (std::abs(score) > MATE_BOUND && MATE_SCORE - std::abs(score) <= iterationDepth) break;
+        if (engine.timeUp(result.seconds, 0.5)) break;
+    }
+
+    engine.totalNodes += pendingNodes;
+    pendingNodes = 0;
+}
+
+int SearchWorker::alphaBeta(int alpha, int beta, int depth, int ply) {
+    if (depth <= 0) return quiescence(alpha, beta, ply);
+
+    countNode();
+    if (stopped) return 0;
+
+    const Position& pos = state.position();
+    uint64_t key = state.hash();
+    if (ply > 0 && isRepetition(key, ply)) return 0;
+    keyStack[ply] = key;
+
+    const Tablebase* tablebase = engine.tablebase;
+    if (tablebase && ply > 0 && popCount(pos.occupied()) <= tablebase->maxPieces()) {
+        TablebaseResult tbResult;
+        if (tablebase->probe(pos, tbResult) && tbResult.value != TB_UNKNOWN) {
+            PROFILE_COUNTER("tablebase hits", 1);
+            if (tbResult.value == TB_DRAW) return 0;
+            int score = TABLEBASE_WIN_SCORE - ply - tbResult.distance;
+            return tbResult.value == TB_WIN ? score : -score;
+        }
+    }
+
+    if (state.isLost()) return -MATE_SCORE + ply;
+    if (ply >= MAX_PLY - 1) return evaluate(pos);
+
+    MoveList& moves = moveStack[ply];
+    state.generateMoves(moves);
+    if (moves.size() == 1 && ply > 0) ++depth;
+
+    int ttMove = NO_TT_MOVE;
+    TTEntry entry;
+    if (engine.tt.probe(key, entry)) {
+        if (entry.moveIndex < static_cast<int>(moves.size())) ttMove = entry.moveIndex;
+        if (ply > 0 && entry.depth >= depth) {
+            int score = scoreFromTT(entry.score, ply);
+            if (entry.bound == Bound::Exact ||
+                (entry.bound == Bound::Lower && score >= beta) ||
+                (entry.bound == Bound::Upper && score <= alpha)) {
+                return score;
+            }
+        }
+    }
+
+    uint8_t order[MAX_MOVES];
+    orderMoves(moves, ply, ttMove, order);
+
+    int originalAlpha = alpha;
+    int bestScore = -INFINITE_SCORE;
+    int bestIndex = NO_TT_MOVE;
+
+    for (size_t k = 0; k < moves.size(); ++k) {
+        const Move& move = moves[order[k]];
+        bool reversible = !move.isCapture() && (pos.kings & squareBit(move.from));
+        reversibleStack[ply + 1] = reversible ? reversibleStack[ply] + 1 : 0;
+        state.makeMove(move);
+
+        int score;
+        if (k == 0) {
+            score = -alphaBeta(-beta, -alpha, depth - 1, ply + 1);
+        } else {
+            score = -alphaBeta(-alpha - 1, -alpha, depth - 1, ply + 1);
+            if (score > alpha && score < beta) {
+                score = -alphaBeta(-beta, -alpha, depth - 1, ply + 1);
+            }
+        }
+        state.unmakeMove();
+        if (stopped) return 0;
+
+        if (score > bestScore) {
+            bestScore = score;
+            bestIndex = order[k];
+            if (ply == 0) rootBest = move;
+        }
+        if (score > alpha) alpha = score;
+        if (alpha >= beta) {
+            if (!move.isCapture()) updateQuietStats(move, depth, ply);
+            break;
+        }
+    }
+
+    Bound bound = bestScore >= beta ? Bound::Lower : bestScore > originalAlpha ? Bound::Exact : Bound::Upper;
+    engine.tt.store(key, scoreToTT(bestScore, ply), depth, bound, bestIndex);
+    return bestScore;
+}
+
+int SearchWorker::quiescence(int alpha, int beta, int ply) {
+    countNode();
+    if (stopped) return 0;
+
+    if (state.isLost()) return -MATE_SCORE + ply;
+    if (!state.mustCapture() || ply >= MAX_PLY - 1) return evaluate(state.position());
+
+    MoveList& moves = moveStack[ply];
+    state.generateMoves(moves);
+
+    uint8_t order[MAX_MOVES];
+    orderMoves(moves, ply, NO_TT_MOVE, order);
+
+    // Captures are forced, so there is no stand-pat option here.
+    int bestScore = -INFINITE_SCORE;
+    for (size_t k = 0; k < moves.size(); ++k) {
+        state.makeMove(moves[order[k]]);
+        int score = -quiescence(-beta, -alpha, ply + 1);
+        state.unmakeMove();
+        if (stopped) return 0;
+
+        if (score > bestScore) bestScore = score;
+        if (score > alpha) alpha = score;
+        if (alpha >= beta) break;
+    }
+    return bestScore;
+}
+
+// Fills `order` with move indices by descending score, ties by index. The
+// lists are short, so an insertion sort on the stack beats std::sort.
+void SearchWorker::orderMoves(const MoveList& moves, int ply, int ttMove, uint8_t* order) {
+    int scores[MAX_MOVES];
+    int count = static_cast<int>(moves.size());
+
+    for (int i = 0; i < count; ++i) {
+        const Move& move = moves[i];
+        int score;
+        if (i == ttMove) score = 1 << 30;
+        else if (move.isCapture()) score = (1 << 20) + popCount(move.captured) * 1000 + move.promotion;
+        else if (sameMove(move, killers[ply][0])) score = 1 << 19;
+        else if (sameMove(move, killers[ply][1])) score = 1 << 18;
+        else score = history[move.from][move.to] + (move.promotion ? HISTORY_LIMIT : 0);
+
+        int j = i;
+        while (j > 0 && scores[j - 1] < score) {
+            scores[j] = scores[j - 1];
+            order[j] = order[j - 1];
+            --j;
+        }
+        scores[j] = score;
+        order[j] = static_cast<uint8_t>(i);
+    }
+}
+
+void SearchWorker::updateQuietStats(const Move& move, int depth, int ply) {
+    if (!sameMove(move, killers[ply][0])) {
+        killers[ply][1] = killers[ply][0];
+        killers[ply][0] = move;
+    }
+
+    int& value = history[move.from][move.to];
+    value += depth * depth;
+    if (value > HISTORY_LIMIT) {
+        for (auto& row : history) {
+            for (auto& entry : row) entry /= 2;
+        }
+    }
+}
+
+// Only positions with the same side to move since the last capture or man
+// move can recur; below the root the scan goes on in the game history,
+// whose last entry is the root itself.
+bool SearchWorker::isRepetition(uint64_t key, int ply) const {
+    const std::vector<uint64_t>& played = engine.gameHistory;
+    int root = static_cast<int>(played.size()) - 1;
+    for (int i = ply - 2; i >= ply - reversibleStack[ply]; i -= 2) {
+        if ((i >= 0 ? keyStack[i] : played[root + i]) == key) return true;
+    }
+    return false;
+}
+
+void SearchWorker::countNode() {
+    if (++pendingNodes < NODE_BATCH) return;
+
+    uint64_t nodes = engine.totalNodes += pendingNodes;
+    pendingNodes = 0;
+
+    const SearchLimits& limits = engine.limits;
+    if (engine.aborted || engine.stopRequested || (limits.cancel && *limits.cancel)) {
+        stopped = true;
+        return;
+    }
+    if (id != 0 || iterationDepth <= 1) return;
+
+    if ((limits.nodes > 0 && nodes >= limits.nodes) ||
+        engine.timeUp(engine.elapsedSeconds(), 1.0)) {
+        stopped = true;
+    }
+}
+
+std::vector<Move> SearchWorker::extractPv(const Position& pos, int maxLength) {
+    std::vector<Move> pv;
+    std::vector<uint64_t> seen;
+    MoveList moves;
+    Position current = pos;
+
+    while (static_cast<int>(pv.size()) < maxLength) {
+        uint64_t key = hashPosition(current);
+        TTEntry entry;
+        if (std::find(seen.begin(), seen.end(), key) != seen.end() || !engine.tt.probe(key, entry)) break;
+        seen.push_back(key);
+
+        generateMoves(current, moves);
+        if (entry.moveIndex >= static_cast<int>(moves.size())) break;
+        pv.push_back(moves[entry.moveIndex]);
+        makeMove(current, moves[entry.moveIndex]);
+    }
+    return pv;
+}
+
+Engine::Engine(size_t hashMegabytes, int threads) : tt(hashMegabytes) {
+    setThreads(threads);
+}
+
+Engine::~Engine() = default;
+
+void Engine::setHashSize(size_t megabytes) {
+    tt.resize(megabytes);
+}
+
+void Engine::setThreads(int threads) {
+    if (threads < 1) threads = 1;
+    workers.clear();
+    for (int i = 0; i < threads; ++i) {
+        workers.emplace_back(new SearchWorker(*this, i));
+    }
+}
+
+void Engine::newGame() {
+    tt.clear();
+    gameHistory.clear();
+    for (auto& worker : workers) worker->clearHistory();
+}
+
+SearchResult Engine::search(const Position& pos, const SearchLimits& searchLimits,
+                            const SearchCallback& onIteration) {
+    PROFILE_ZONE("Engine::search");
+    limits = searchLimits;
+    startTime = std::chrono::steady_clock::now();
+    stopRequested = false;
+    aborted = false;
+    totalNodes = 0;
+    timeOriginMs = 0;
+    timeLimitMs = limits.moveTimeMs;
+    tt.newSearch();
+
+    SearchResult result;
+    MoveList rootMoves;
+    generateMoves(pos, rootMoves);
+    if (rootMoves.empty()) {
+        result.score = -MATE_SCORE;
+        return result;
+    }
+
+    result.bestMove = rootMoves.front();
+    result.hasMove = true;
+    result.pv.push_back(result.bestMove);
+    if (rootMoves.size() == 1 && limits.moveTimeMs > 0) return result;
+
+    std::vector<std::thread> helpers;
+    std::vector<SearchResult> helperResults(workers.size());
+    for (size_t i = 1; i < workers.size(); ++i) {
+        helpers.emplace_back([this, &pos, &helperResults, i]() {
+            workers[i]->iterate(pos, helperResults[i], nullptr);
+        });
+    }
+
+    workers[0]->iterate(pos, result, onIteration);
+    aborted = true;
+    for (auto& helper : helpers) helper.join();
+
+    result.nodes = totalNodes;
+    result.seconds = elapsedSeconds();
+    PROFILE_COUNTER("search nodes", static_cast<int64_t>(result.nodes));
+    return result;
+}
+
+double Engine::elapsedSeconds() const {
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - startTime;
+    return elapsed.count();
+}
+
+// True once `fraction` of the time limit has passed; iterative deepening stops
+// at half the budget since the next depth would rarely finish.
+bool Engine::timeUp(double seconds, double fraction) const {
+    int limit = timeLimitMs;
+    return limit > 0 && seconds * 1000 - timeOriginMs >= limit * fraction;
+}
+
+void Engine::ponderHit(int moveTimeMs) {
+    timeOriginMs = static_cast<int>(elapsedSeconds() * 1000);
+    timeLimitMs = moveTimeMs;
+}
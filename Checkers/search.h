@@ -0,0 +1,88 @@
+#ifndef SEARCH_H
+#define SEARCH_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "bitboard.h"
+#include "tt.h"
+
+const int MAX_PLY = 128;
+const int MAX_DEPTH = 64;
+
+struct SearchLimits {
+    int depth = MAX_DEPTH;
+    int moveTimeMs = 0;     // 0 = no time limit
+    uint64_t nodes = 0;     // 0 = no node limit
+    // Polled like Engine::stop() but never reset by the engine, so a caller
+    // can cancel a search that has not started yet.
+    const std::atomic<bool>* cancel = nullptr;
+};
+
+struct SearchResult {
+    Move bestMove;
+    bool hasMove = false;
+    int score = 0;
+    int depth = 0;
+    uint64_t nodes = 0;
+    double seconds = 0;
+    std::vector<Move> pv;
+};
+
+typedef std::function<void(const SearchResult&)> SearchCallback;
+
+class SearchWorker;
+class Tablebase;
+
+// Iterative-deepening PVS with killer/history move ordering and a quiescence
+// search that resolves pending captures. With more than one thread the search
+// is Lazy SMP: every worker runs its own iterative deepening over the shared
+// lock-free transposition table and the main worker reports the result.
+class Engine {
+public:
+    explicit Engine(size_t hashMegabytes = 16, int threads = 1);
+    ~Engine();
+
+    void setHashSize(size_t megabytes);
+    void setThreads(int threads);
+    int threadCount() const { return static_cast<int>(workers.size()); }
+    void setTablebase(const Tablebase* tb) { tablebase = tb; }
+    // Keys of the game's positions since the last capture or man move, the
+    // position to search last; nothing older can repeat.
+    void setGameHistory(const std::vector<uint64_t>& hashes) { gameHistory = hashes; }
+    void newGame();
+
+    // Blocks until a limit is hit or stop() is called from another thread.
+    // `onIteration` is invoked after every depth completed by the main worker.
+    SearchResult search(const Position& pos, const SearchLimits& limits,
+                        const SearchCallback& onIteration = nullptr);
+    void stop() { stopRequested = true; }
+    // Starts a `moveTimeMs` clock now on a search running without a time
+    // limit, e.g. when the move pondered on is actually played.
+    void ponderHit(int moveTimeMs);
+
+private:
+    friend class SearchWorker;
+
+    double elapsedSeconds() const;
+    bool timeUp(double seconds, double fraction) const;
+
+    TranspositionTable tt;
+    const Tablebase* tablebase = nullptr;
+    std::vector<std::unique_ptr<SearchWorker>> workers;
+    std::vector<uint64_t> gameHistory;
+
+    SearchLimits limits;
+    std::chrono::steady_clock::time_point startTime;
+    std::atomic<bool> stopRequested{false};
+    std::atomic<bool> aborted{false};
+    std::atomic<uint64_t> totalNodes{0};
+    std::atomic<int> timeLimitMs{0};        // 0 = none; counted from timeOriginMs
+    std::atomic<int> timeOriginMs{0};
+};
+
+#endif // SEARCH_H
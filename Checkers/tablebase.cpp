@@ -0,0 +1,353 @@
+#include "tablebase.h"
+
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+const char MAGIC[4] = {'C', 'K', 'T', 'B'};
+const uint32_t VERSION = 1;
+const uint32_t FLAG_DISTANCE = 1;
+const uint32_t BLOCK_POSITIONS = 2048;
+const int KEY_BASE = MAX_TABLEBASE_PIECES + 1;
+
+const Bitboard WHITE_BACK_SQUARES = 0x0000000Fu;
+const Bitboard WHITE_MID_SQUARES = 0x0FFFFFF0u;
+const Bitboard BLACK_MAN_SQUARES = 0xFFFFFFF0u;
+
+struct FileHeader {
+    char magic[4];
+    uint32_t version;
+    uint8_t material[4];
+    uint32_t flags;
+    uint64_t positions;     // per side to move
+    uint32_t blockSize;
+    uint32_t blockCount;
+};
+static_assert(sizeof(FileHeader) == 32, "tablebase header must be packed");
+
+struct BinomialTable {
+    uint64_t values[33][33] = {};
+
+    BinomialTable() {
+        for (int n = 0; n <= 32; ++n) {
+            values[n][0] = 1;
+            for (int k = 1; k <= n; ++k) values[n][k] = values[n - 1][k - 1] + values[n - 1][k];
+        }
+    }
+};
+
+const BinomialTable BINOMIALS;
+
+uint64_t binomial(int n, int k) {
+    if (k < 0 || n < 0 || k > n) return 0;
+    return BINOMIALS.values[n][k];
+}
+
+// Rank of `pieces` among the squares of `allowed`, as a combinadic.
+uint64_t rankSet(Bitboard pieces, Bitboard allowed) {
+    uint64_t rank = 0;
+    int i = 1;
+    while (pieces) {
+        int sq = popLowest(pieces);
+        rank += binomial(popCount(allowed & (squareBit(sq) - 1)), i++);
+    }
+    return rank;
+}
+
+Bitboard unrankSet(uint64_t rank, int count, Bitboard allowed) {
+    Bitboard pieces = 0;
+    for (int i = count; i >= 1; --i) {
+        int c = i - 1;
+        while (binomial(c + 1, i) <= rank) ++c;
+        rank -= binomial(c, i);
+
+        Bitboard squares = allowed;
+        for (int skip = 0; skip < c; ++skip) squares &= squares - 1;
+        pieces |= squareBit(lowestSquare(squares));
+    }
+    return pieces;
+}
+
+void encodeRuns(const uint8_t* in, size_t n, std::vector<uint8_t>& out) {
+    size_t i = 0;
+    while (i < n) {
+        size_t run = 1;
+        while (i + run < n && in[i + run] == in[i] && run < 130) ++run;
+        if (run >= 3) {
+            out.push_back(static_cast<uint8_t>(128 + run - 3));
+            out.push_back(in[i]);
+            i += run;
+            continue;
+        }
+
+        size_t start = i;
+        while (i < n && i - start < 128) {
+            if (i + 2 < n && in[i] == in[i + 1] && in[i] == in[i + 2]) break;
+            ++i;
+        }
+        out.push_back(static_cast<uint8_t>(i - start - 1));
+        out.insert(out.end(), in + start, in + i);
+    }
+}
+
+// Decodes only as far as needed to return the byte at `offset`.
+uint8_t decodeRunsAt(const uint8_t* data, size_t length, size_t offset) {
+    size_t decoded = 0;
+    size_t p = 0;
+    while (p < length) {
+        uint8_t control = data[p++];
+        if (control < 128) {
+            size_t n = control + 1u;
+            if (offset < decoded + n) return data[p + offset - decoded];
+            decoded += n;
+            p += n;
+        } else {
+            size_t n = control - 128u + 3u;
+            if (offset < decoded + n) return data[p];
+            decoded += n;
+            ++p;
+        }
+    }
+    return 0;
+}
+
+uint64_t readOffset(const uint8_t* table, size_t index) {
+    uint64_t value;
+    std::memcpy(&value, table + index * sizeof(uint64_t), sizeof(value));
+    return value;
+}
+
+} // namespace
+
+int Material::key() const {
+    if (whiteMen > MAX_TABLEBASE_PIECES || whiteKings > MAX_TABLEBASE_PIECES ||
+        blackMen > MAX_TABLEBASE_PIECES || blackKings > MAX_TABLEBASE_PIECES) {
+        return -1;
+    }
+    return ((whiteMen * KEY_BASE + whiteKings) * KEY_BASE + blackMen) * KEY_BASE + blackKings;
+}
+
+std::string Material::name() const {
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "w%d%db%d%d", whiteMen, whiteKings, blackMen, blackKings);
+    return buffer;
+}
+
+Material materialOf(const Position& pos) {
+    Material material;
+    material.whiteMen = popCount(pos.white & ~pos.kings);
+    material.whiteKings = popCount(pos.white & pos.kings);
+    material.blackMen = popCount(pos.black & ~pos.kings);
+    material.blackKings = popCount(pos.black & pos.kings);
+    return material;
+}
+
+TablebaseIndexer::TablebaseIndexer(const Material& m) : material(m) {
+    int wm = m.whiteMen;
+    int bm = m.blackMen;
+    firstSlice = wm > 24 ? wm - 24 : 0;
+    lastSlice = wm < 4 ? wm : 4;
+
+    uint64_t kingPlacements = binomial(32 - wm - bm, m.whiteKings) *
+                              binomial(32 - wm - bm - m.whiteKings, m.blackKings);
+    for (int k = firstSlice; k <= lastSlice; ++k) {
+        sliceOffset[k] = total;
+        total += binomial(4, k) * binomial(24, wm - k) * binomial(28 - (wm - k), bm) * kingPlacements;
+    }
+    sliceOffset[lastSlice + 1] = total;
+}
+
+uint64_t TablebaseIndexer::index(const Position& pos) const {
+    Bitboard whiteMen = pos.white & ~pos.kings;
+    Bitboard blackMen = pos.black & ~pos.kings;
+    Bitboard whiteKings = pos.white & pos.kings;
+    Bitboard blackKings = pos.black & pos.kings;
+    Bitboard whiteMid = whiteMen & WHITE_MID_SQUARES;
+    Bitboard men = whiteMen | blackMen;
+
+    int wm = material.whiteMen;
+    int bm = material.blackMen;
+    int k = popCount(whiteMen & WHITE_BACK_SQUARES);
+    uint64_t free = 32 - wm - bm;
+
+    uint64_t index = rankSet(whiteMen & WHITE_BACK_SQUARES, WHITE_BACK_SQUARES);
+    index = index * binomial(24, wm - k) + rankSet(whiteMid, WHITE_MID_SQUARES);
+    index = index * binomial(28 - (wm - k), bm) + rankSet(blackMen, BLACK_MAN_SQUARES & ~whiteMid);
+    index = index * binomial(free, material.whiteKings) + rankSet(whiteKings, ~men);
+    index = index * binomial(free - material.whiteKings, material.blackKings) +
+            rankSet(blackKings, ~(men | whiteKings));
+    return sliceOffset[k] + index;
+}
+
+void TablebaseIndexer::position(uint64_t index, PieceColor sideToMove, Position& pos) const {
+    int k = firstSlice;
+    while (index >= sliceOffset[k + 1]) ++k;
+    index -= sliceOffset[k];
+
+    int wm = material.whiteMen;
+    int bm = material.blackMen;
+    int free = 32 - wm - bm;
+
+    uint64_t kingBase = binomial(free - material.whiteKings, material.blackKings);
+    uint64_t blackKingIndex = index % kingBase;
+    index /= kingBase;
+    kingBase = binomial(free, material.whiteKings);
+    uint64_t whiteKingIndex = index % kingBase;
+    index /= kingBase;
+    uint64_t blackBase = binomial(28 - (wm - k), bm);
+    uint64_t blackIndex = index % blackBase;
+    index /= blackBase;
+    uint64_t midBase = binomial(24, wm - k);
+    uint64_t midIndex = index % midBase;
+    uint64_t backIndex = index / midBase;
+
+    Bitboard whiteMid = unrankSet(midIndex, wm - k, WHITE_MID_SQUARES);
+    Bitboard whiteMen = unrankSet(backIndex, k, WHITE_BACK_SQUARES) | whiteMid;
+    Bitboard blackMen = unrankSet(blackIndex, bm, BLACK_MAN_SQUARES & ~whiteMid);
+    Bitboard men = whiteMen | blackMen;
+    Bitboard whiteKings = unrankSet(whiteKingIndex, material.whiteKings, ~men);
+    Bitboard blackKings = unrankSet(blackKingIndex, material.blackKings, ~(men | whiteKings));
+
+    pos.white = whiteMen | whiteKings;
+    pos.black = blackMen | blackKings;
+    pos.kings = whiteKings | blackKings;
+    pos.sideToMove = sideToMove;
+}
+
+bool writeTablebaseFile(const std::string& path, const Material& material,
+                        const std::vector<uint16_t> values[2], bool storeDistance) {
+    FileHeader header;
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.material[0] = static_cast<uint8_t>(material.whiteMen);
+    header.material[1] = static_cast<uint8_t>(material.whiteKings);
+    header.material[2] = static_cast<uint8_t>(material.blackMen);
+    header.material[3] = static_cast<uint8_t>(material.blackKings);
+    header.flags = storeDistance ? FLAG_DISTANCE : 0;
+    header.positions = values[0].size();
+    header.blockSize = BLOCK_POSITIONS;
+    header.blockCount = static_cast<uint32_t>((header.positions + BLOCK_POSITIONS - 1) / BLOCK_POSITIONS);
+
+    int streams = storeDistance ? 4 : 2;
+    std::vector<uint64_t> offsets;
+    std::vector<uint8_t> data;
+    std::vector<uint8_t> raw;
+
+    for (int stream = 0; stream < streams; ++stream) {
+        const std::vector<uint16_t>& codes = values[stream & 1];
+        bool distance = stream >= 2;
+
+        for (uint32_t block = 0; block < header.blockCount; ++block) {
+            size_t begin = static_cast<size_t>(block) * BLOCK_POSITIONS;
+            size_t end = begin + BLOCK_POSITIONS < codes.size() ? begin + BLOCK_POSITIONS : codes.size();
+
+            raw.assign(distance ? end - begin : (end - begin + 3) / 4, 0);
+            for (size_t i = begin; i < end; ++i) {
+                if (distance) {
+                    uint16_t plies = codes[i] >> 2;
+                    raw[i - begin] = static_cast<uint8_t>(plies > 255 ? 255 : plies);
+                } else {
+                    raw[(i - begin) / 4] |= static_cast<uint8_t>((codes[i] & 3) << (((i - begin) % 4) * 2));
+                }
+            }
+
+            offsets.push_back(data.size());
+            encodeRuns(raw.data(), raw.size(), data);
+        }
+        offsets.push_back(data.size());
+    }
+
+    FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) return false;
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+              std::fwrite(offsets.data(), sizeof(uint64_t), offsets.size(), file) == offsets.size() &&
+              std::fwrite(data.data(), 1, data.size(), file) == data.size();
+    return std::fclose(file) == 0 && ok;
+}
+
+struct Tablebase::Table {
+    MappedFile file;
+    TablebaseIndexer indexer;
+    const uint8_t* offsets = nullptr;
+    const uint8_t* data = nullptr;
+    uint32_t blockSize = 0;
+    uint32_t blockCount = 0;
+    bool hasDistance = false;
+
+    explicit Table(const Material& material) : indexer(material) {}
+
+    uint8_t byteAt(int stream, uint64_t block, size_t offset) const {
+        size_t slot = static_cast<size_t>(stream) * (blockCount + 1) + block;
+        uint64_t begin = readOffset(offsets, slot);
+        uint64_t end = readOffset(offsets, slot + 1);
+        return decodeRunsAt(data + begin, static_cast<size_t>(end - begin), offset);
+    }
+};
+
+Tablebase::Tablebase() : byMaterial(KEY_BASE * KEY_BASE * KEY_BASE * KEY_BASE, nullptr) {
+}
+
+Tablebase::~Tablebase() = default;
+
+int Tablebase::load(const std::string& directory, int maxPieces) {
+    if (maxPieces > MAX_TABLEBASE_PIECES) maxPieces = MAX_TABLEBASE_PIECES;
+    int loaded = 0;
+
+    Material m;
+    for (m.whiteMen = 0; m.whiteMen <= maxPieces; ++m.whiteMen)
+    for (m.whiteKings = 0; m.whiteKings <= maxPieces; ++m.whiteKings)
+    for (m.blackMen = 0; m.blackMen <= maxPieces; ++m.blackMen)
+    for (m.blackKings = 0; m.blackKings <= maxPieces; ++m.blackKings) {
+        if (m.total() > maxPieces || m.whiteMen + m.whiteKings == 0 || m.blackMen + m.blackKings == 0) continue;
+
+        std::unique_ptr<Table> table(new Table(m));
+        if (!table->file.open(directory + "/" + m.name() + ".cktb")) continue;
+        if (table->file.size() < sizeof(FileHeader)) continue;
+
+        FileHeader header;
+        std::memcpy(&header, table->file.data(), sizeof(header));
+        if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION ||
+            header.positions != table->indexer.size()) {
+            continue;
+        }
+
+        table->blockSize = header.blockSize;
+        table->blockCount = header.blockCount;
+        table->hasDistance = (header.flags & FLAG_DISTANCE) != 0;
+        size_t streams = table->hasDistance ? 4 : 2;
+        table->offsets = table->file.data() + sizeof(FileHeader);
+        table->data = table->offsets + streams * (header.blockCount + 1) * sizeof(uint64_t);
+        if (table->data > table->file.data() + table->file.size()) continue;
+
+        byMaterial[m.key()] = table.get();
+        tables.push_back(std::move(table));
+        if (m.total() > pieceLimit) pieceLimit = m.total();
+        ++loaded;
+    }
+    return loaded;
+}
+
+bool Tablebase::probe(const Position& pos, TablebaseResult& result) const {
+    if (!pos.own()) {
+        result.value = TB_LOSS;
+        result.distance = 0;
+        return true;
+    }
+
+    Material material = materialOf(pos);
+    if (material.total() > pieceLimit) return false;
+    int key = material.key();
+    const Table* table = key >= 0 ? byMaterial[key] : nullptr;
+    if (!table) return false;
+
+    uint64_t index = table->indexer.index(pos);
+    uint64_t block = index / table->blockSize;
+    size_t offset = static_cast<size_t>(index % table->blockSize);
+    int side = pos.sideToMove == PieceColor::White ? 0 : 1;
+
+    uint8_t packed = table->byteAt(side, block, offset / 4);
+    result.value = static_cast<TablebaseValue>((packed >> ((offset % 4) * 2)) & 3);
+    result.distance = table->hasDistance ? table->byteAt(2 + side, block, offset) : 0;
+    return true;
+}
@@ -0,0 +1,80 @@
+#ifndef TABLEBASE_H
+#define TABLEBASE_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "bitboard.h"
+#include "mapped_file.h"
+
+const int MAX_TABLEBASE_PIECES = 8;
+
+enum TablebaseValue : uint8_t { TB_UNKNOWN = 0, TB_WIN = 1, TB_LOSS = 2, TB_DRAW = 3 };
+
+struct Material {
+    int whiteMen = 0;
+    int whiteKings = 0;
+    int blackMen = 0;
+    int blackKings = 0;
+
+    int total() const { return whiteMen + whiteKings + blackMen + blackKings; }
+    int key() const;
+    std::string name() const;
+};
+
+Material materialOf(const Position& pos);
+
+// Perfect index of all placements of a material signature. White men live on
+// rows 0-6 and Black men on rows 1-7; the index is split into slices by the
+// number of White men on row 0 so that Black men can be ranked among exactly
+// the squares left free for them.
+class TablebaseIndexer {
+public:
+    explicit TablebaseIndexer(const Material& material);
+
+    uint64_t size() const { return total; }
+    uint64_t index(const Position& pos) const;
+    void position(uint64_t index, PieceColor sideToMove, Position& pos) const;
+
+private:
+    Material material;
+    int firstSlice = 0;
+    int lastSlice = 0;
+    uint64_t sliceOffset[6] = {};
+    uint64_t total = 0;
+};
+
+struct TablebaseResult {
+    TablebaseValue value = TB_UNKNOWN;   // from the side to move's view
+    int distance = 0;                    // plies to the end, 0 if not stored
+};
+
+// Writes one material signature. `values` holds, per side to move, the
+// generator's (distance << 2 | value) codes.
+bool writeTablebaseFile(const std::string& path, const Material& material,
+                        const std::vector<uint16_t> values[2], bool storeDistance);
+
+// Read-only prober over memory-mapped files; probe() never allocates.
+class Tablebase {
+public:
+    Tablebase();
+    ~Tablebase();
+
+    // Maps every file for up to `maxPieces` pieces found in `directory` and
+    // returns the number of tables loaded.
+    int load(const std::string& directory, int maxPieces);
+    int maxPieces() const { return pieceLimit; }
+
+    bool probe(const Position& pos, TablebaseResult& result) const;
+
+private:
+    struct Table;
+
+    std::vector<std::unique_ptr<Table>> tables;
+    std::vector<const Table*> byMaterial;
+    int pieceLimit = 0;
+};
+
+#endif // TABLEBASE_H
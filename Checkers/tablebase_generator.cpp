@@ -0,0 +1,322 @@
+#include "tablebase_generator.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "tablebase.h"
+
+namespace {
+
+const uint64_t CHUNK_SIZE = 4096;
+const uint64_t SIDE_BIT = 1ull << 63;
+const uint64_t CLAIM_BIT = 1ull << 62;   // tentative win from a finished table
+
+uint16_t makeCode(TablebaseValue value, int distance) {
+    return static_cast<uint16_t>(distance << 2 | value);
+}
+
+struct Slice {
+    Material material;
+    TablebaseIndexer indexer;
+    std::vector<uint16_t> values[2];
+
+    explicit Slice(const Material& m) : material(m), indexer(m) {}
+};
+
+// Per-position solving state for one side to move.
+struct WorkingTable {
+    std::unique_ptr<std::atomic<uint16_t>[]> code;
+    std::unique_ptr<std::atomic<uint8_t>[]> pending;    // successors not yet known to win
+    std::unique_ptr<std::atomic<uint16_t>[]> slowest;   // longest win among them, +1
+
+    void reset(uint64_t size) {
+        code.reset(new std::atomic<uint16_t>[size]);
+        pending.reset(new std::atomic<uint8_t>[size]);
+        slowest.reset(new std::atomic<uint16_t>[size]);
+        for (uint64_t i = 0; i < size; ++i) {
+            code[i].store(0, std::memory_order_relaxed);
+            pending[i].store(0, std::memory_order_relaxed);
+            slowest[i].store(0, std::memory_order_relaxed);
+        }
+    }
+};
+
+typedef std::map<int, std::vector<uint64_t>> Buckets;
+
+class Generator {
+public:
+    explicit Generator(const TablebaseGeneratorOptions& options)
+        : options(options), finished(MAX_TABLEBASE_PIECES * 6561 + 1) {}
+
+    bool run();
+
+private:
+    void solve(Slice& slice);
+    void initialize(const Slice& slice, Buckets& buckets);
+    void propagate(const Slice& slice, uint64_t entry, int distance, Buckets& buckets);
+    void resolveLoss(int side, uint64_t index, Buckets& buckets);
+    uint16_t lookupFinished(const Position& pos) const;
+    void log(const std::string& message) const {
+        if (options.log) options.log(message);
+    }
+
+    // Runs fn(item, localBuckets) over [0, count) on all threads and merges
+    // the buckets each thread produced.
+    template <typename Fn>
+    void parallelFor(uint64_t count, Buckets& buckets, Fn fn);
+
+    const TablebaseGeneratorOptions& options;
+    std::vector<std::unique_ptr<Slice>> finished;
+    WorkingTable working[2];
+};
+
+template <typename Fn>
+void Generator::parallelFor(uint64_t count, Buckets& buckets, Fn fn) {
+    int threads = std::max(1, options.threads);
+    std::vector<Buckets> local(threads);
+    std::atomic<uint64_t> nextChunk(0);
+
+    auto worker = [&](int id) {
+        for (uint64_t begin = nextChunk.fetch_add(CHUNK_SIZE); begin < count;
+             begin = nextChunk.fetch_add(CHUNK_SIZE)) {
+            uint64_t end = std::min(begin + CHUNK_SIZE, count);
+            for (uint64_t i = begin; i < end; ++i) fn(i, local[id]);
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (int i = 1; i < threads; ++i) pool.emplace_back(worker, i);
+    worker(0);
+    for (auto& thread : pool) thread.join();
+
+    for (auto& produced : local) {
+        for (auto& level : produced) {
+            std::vector<uint64_t>& target = buckets[level.first];
+            target.insert(target.end(), level.second.begin(), level.second.end());
+        }
+    }
+}
+
+uint16_t Generator::lookupFinished(const Position& pos) const {
+    if (!pos.own()) return makeCode(TB_LOSS, 0);
+
+    const Slice* slice = finished[materialOf(pos).key()].get();
+    if (!slice) return makeCode(TB_UNKNOWN, 0);
+    int side = pos.sideToMove == PieceColor::White ? 0 : 1;
+    return slice->values[side][slice->indexer.index(pos)];
+}
+
+// Counts every position's moves once. Moves that capture or promote leave the
+// slice and are scored straight from finished tables.
+void Generator::initialize(const Slice& slice, Buckets& buckets) {
+    uint64_t size = slice.indexer.size();
+
+    parallelFor(2 * size, buckets, [&](uint64_t i, Buckets& out) {
+        int side = i < size ? 0 : 1;
+        uint64_t index = i % size;
+        Position pos;
+        slice.indexer.position(index, side == 0 ? PieceColor::White : PieceColor::Black, pos);
+
+        MoveList moves;
+        generateMoves(pos, moves);
+
+        int fastestWin = 1 << 20;
+        int slowestLoss = 0;
+        int pending = 0;
+        for (const auto& move : moves) {
+            if (!move.isCapture() && !move.promotion) {
+                ++pending;
+                continue;
+            }
+            Position next = pos;
+            makeMove(next, move);
+            uint16_t code = lookupFinished(next);
+            int distance = (code >> 2) + 1;
+            if ((code & 3) == TB_LOSS) fastestWin = std::min(fastestWin, distance);
+            if ((code & 3) == TB_WIN) slowestLoss = std::max(slowestLoss, distance);
+            else ++pending;
+        }
+
+        WorkingTable& table = working[side];
+        table.pending[index].store(static_cast<uint8_t>(pending), std::memory_order_relaxed);
+        table.slowest[index].store(static_cast<uint16_t>(slowestLoss), std::memory_order_relaxed);
+
+        uint64_t entry = index | (side ? SIDE_BIT : 0);
+        if (fastestWin < (1 << 20)) {
+            out[fastestWin].push_back(entry | CLAIM_BIT);
+        } else if (pending == 0) {
+            table.code[index].store(makeCode(TB_LOSS, slowestLoss), std::memory_order_relaxed);
+            out[slowestLoss].push_back(entry);
+        }
+    });
+}
+
+void Generator::resolveLoss(int side, uint64_t index, Buckets& buckets) {
+    WorkingTable& table = working[side];
+    int distance = table.slowest[index].load(std::memory_order_acquire);
+    table.code[index].store(makeCode(TB_LOSS, distance), std::memory_order_relaxed);
+    buckets[distance].push_back(index | (side ? SIDE_BIT : 0));
+}
+
+// Walks every quiet move that could have led to the resolved position and
+// updates the predecessor: a loss here wins there, and once every move of the
+// predecessor is known to win for us, the predecessor is lost.
+void Generator::propagate(const Slice& slice, uint64_t entry, int distance, Buckets& out) {
+    int side = (entry & SIDE_BIT) ? 1 : 0;
+    uint64_t index = entry & ~(SIDE_BIT | CLAIM_BIT);
+
+    if (entry & CLAIM_BIT) {
+        uint16_t expected = makeCode(TB_UNKNOWN, 0);
+        if (!working[side].code[index].compare_exchange_strong(expected, makeCode(TB_WIN, distance))) return;
+    }
+
+    TablebaseValue value = static_cast<TablebaseValue>(working[side].code[index].load(std::memory_order_relaxed) & 3);
+    Position pos;
+    slice.indexer.position(index, side == 0 ? PieceColor::White : PieceColor::Black, pos);
+
+    PieceColor mover = opponent(pos.sideToMove);
+    Bitboard movers = mover == PieceColor::White ? pos.white : pos.black;
+    Bitboard empty = pos.empty();
+    int previous = 1 - side;
+    WorkingTable& table = working[previous];
+
+    auto visit = [&](int from, int to) {
+        Position before = pos;
+        Piece piece = before.pieceAt(to);
+        before.setPiece(to, Piece());
+        before.setPiece(from, piece);
+        before.sideToMove = mover;
+        if (hasCapture(before)) return;
+
+        uint64_t beforeIndex = slice.indexer.index(before);
+        if (value == TB_LOSS) {
+            uint16_t expected = makeCode(TB_UNKNOWN, 0);
+            if (table.code[beforeIndex].compare_exchange_strong(expected, makeCode(TB_WIN, distance + 1))) {
+                out[distance + 1].push_back(beforeIndex | (previous ? SIDE_BIT : 0));
+            }
+        } else if (value == TB_WIN) {
+            std::atomic<uint16_t>& slowest = table.slowest[beforeIndex];
+            uint16_t current = slowest.load(std::memory_order_relaxed);
+            while (current < distance + 1 &&
+                   !slowest.compare_exchange_weak(current, static_cast<uint16_t>(distance + 1))) {
+            }
+            if (table.pending[beforeIndex].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                resolveLoss(previous, beforeIndex, out);
+            }
+        }
+    };
+
+    Bitboard pieces = movers;
+    while (pieces) {
+        int sq = popLowest(pieces);
+        if (pos.kings & squareBit(sq)) {
+            for (int dir = 0; dir < 4; ++dir) {
+                for (Bitboard from = shift(squareBit(sq), dir); from & empty; from = shift(from, dir)) {
+                    visit(lowestSquare(from), sq);
+                }
+            }
+        } else {
+            int back[2] = {UpRight, UpLeft};
+            if (mover == PieceColor::Black) {
+                back[0] = DownRight;
+                back[1] = DownLeft;
+            }
+            for (int dir : back) {
+                Bitboard from = shift(squareBit(sq), dir) & empty;
+                if (from) visit(lowestSquare(from), sq);
+            }
+        }
+    }
+}
+
+void Generator::solve(Slice& slice) {
+    uint64_t size = slice.indexer.size();
+    for (auto& table : working) table.reset(size);
+
+    Buckets buckets;
+    initialize(slice, buckets);
+
+    // Levels are processed in distance order, so the first win found for a
+    // position is the fastest and a loss is only final once all moves win.
+    while (!buckets.empty()) {
+        auto level = buckets.begin();
+        int distance = level->first;
+        std::vector<uint64_t> entries = std::move(level->second);
+        buckets.erase(level);
+
+        parallelFor(entries.size(), buckets, [&](uint64_t i, Buckets& out) {
+            propagate(slice, entries[i], distance, out);
+        });
+    }
+
+    for (int side = 0; side < 2; ++side) {
+        slice.values[side].resize(size);
+        for (uint64_t i = 0; i < size; ++i) {
+            uint16_t code = working[side].code[i].load(std::memory_order_relaxed);
+            slice.values[side][i] = (code & 3) == TB_UNKNOWN ? makeCode(TB_DRAW, 0) : code;
+        }
+        working[side] = WorkingTable();
+    }
+}
+
+bool Generator::run() {
+    std::vector<Material> materials;
+    Material m;
+    int limit = std::min(options.maxPieces, MAX_TABLEBASE_PIECES);
+    for (m.whiteMen = 0; m.whiteMen <= limit; ++m.whiteMen)
+    for (m.whiteKings = 0; m.whiteKings <= limit; ++m.whiteKings)
+    for (m.blackMen = 0; m.blackMen <= limit; ++m.blackMen)
+    for (m.blackKings = 0; m.blackKings <= limit; ++m.blackKings) {
+        if (m.total() <= limit && m.whiteMen + m.whiteKings > 0 && m.blackMen + m.blackKings > 0) {
+            materials.push_back(m);
+        }
+    }
+
+    // Captures lower the piece count and promotions lower the man count, so
+    // this order guarantees every successor table is already finished.
+    std::sort(materials.begin(), materials.end(), [](const Material& a, const Material& b) {
+        if (a.total() != b.total()) return a.total() < b.total();
+        return a.whiteMen + a.blackMen < b.whiteMen + b.blackMen;
+    });
+
+    for (const auto& material : materials) {
+        auto start = std::chrono::steady_clock::now();
+        std::unique_ptr<Slice> slice(new Slice(material));
+        solve(*slice);
+
+        std::string path = options.directory + "/" + material.name() + ".cktb";
+        if (!writeTablebaseFile(path, material, slice->values, options.storeDistance)) {
+            log("failed to write " + path);
+            return false;
+        }
+
+        uint64_t counts[4] = {};
+        for (const auto& side : slice->values) {
+            for (uint16_t code : side) ++counts[code & 3];
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        char line[256];
+        std::snprintf(line, sizeof(line), "%s positions %llu win %llu loss %llu draw %llu time %.2fs",
+                      material.name().c_str(), static_cast<unsigned long long>(2 * slice->indexer.size()),
+                      static_cast<unsigned long long>(counts[TB_WIN]),
+                      static_cast<unsigned long long>(counts[TB_LOSS]),
+                      static_cast<unsigned long long>(counts[TB_DRAW]), elapsed.count());
+        log(line);
+
+        finished[material.key()] = std::move(slice);
+    }
+    return true;
+}
+
+} // namespace
+
+bool generateTablebases(const TablebaseGeneratorOptions& options) {
+    Generator generator(options);
+    return generator.run();
+}
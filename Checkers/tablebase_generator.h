@@ -0,0 +1,22 @@
+#ifndef TABLEBASE_GENERATOR_H
+#define TABLEBASE_GENERATOR_H
+
+#include <functional>
+#include <string>
+
+struct TablebaseGeneratorOptions {
+    int maxPieces = 4;
+    std::string directory = ".";
+    int threads = 1;
+    bool storeDistance = false;
+    std::function<void(const std::string&)> log;
+};
+
+// Retrograde analysis of every material signature with up to `maxPieces`
+// pieces, smallest first so captures and promotions always land in finished
+// tables. Each pass resolves the positions won or lost in exactly that many
+// plies, which keeps the stored distances exact while all threads share one
+// table; whatever is left unresolved is a draw.
+bool generateTablebases(const TablebaseGeneratorOptions& options);
+
+#endif // TABLEBASE_GENERATOR_H
@@ -0,0 +1,98 @@
+#include "tt.h"
+
+namespace {
+
+// data layout: score:16 | depth:8 | bound:2 | moveIndex:8 | generation:8
+uint64_t pack(int score, int depth, Bound bound, int moveIndex, uint32_t generation) {
+    return static_cast<uint64_t>(static_cast<uint16_t>(score)) |
+           static_cast<uint64_t>(depth & 0xFF) << 16 |
+           static_cast<uint64_t>(bound) << 24 |
+           static_cast<uint64_t>(moveIndex & 0xFF) << 26 |
+           static_cast<uint64_t>(generation & 0xFF) << 34;
+}
+
+int unpackDepth(uint64_t data) { return static_cast<int>((data >> 16) & 0xFF); }
+uint32_t unpackGeneration(uint64_t data) { return static_cast<uint32_t>((data >> 34) & 0xFF); }
+
+} // namespace
+
+TranspositionTable::TranspositionTable(size_t megabytes) {
+    resize(megabytes);
+}
+
+void TranspositionTable::resize(size_t mb) {
+    if (mb == 0) mb = 1;
+    size_t count = 1;
+    while (count * 2 * sizeof(Bucket) <= mb * 1024 * 1024) count *= 2;
+
+    buckets.reset(new Bucket[count]);
+    bucketCount = count;
+    megabytes = mb;
+}
+
+void TranspositionTable::clear() {
+    for (size_t i = 0; i < bucketCount; ++i) {
+        for (auto& slot : buckets[i].slots) {
+            slot.check.store(0, std::memory_order_relaxed);
+            slot.data.store(0, std::memory_order_relaxed);
+        }
+    }
+    generation = 0;
+}
+
+bool TranspositionTable::probe(uint64_t key, TTEntry& entry) const {
+    const Bucket& bucket = buckets[key & (bucketCount - 1)];
+    for (const auto& slot : bucket.slots) {
+        uint64_t data = slot.data.load(std::memory_order_relaxed);
+        uint64_t check = slot.check.load(std::memory_order_relaxed);
+        if ((check ^ data) != key || data == 0) continue;
+
+        entry.score = static_cast<int16_t>(data & 0xFFFF);
+        entry.depth = unpackDepth(data);
+        entry.bound = static_cast<Bound>((data >> 24) & 0x3);
+        entry.moveIndex = static_cast<int>((data >> 26) & 0xFF);
+        return true;
+    }
+    return false;
+}
+
+void TranspositionTable::store(uint64_t key, int score, int depth, Bound bound, int moveIndex) {
+    Bucket& bucket = buckets[key & (bucketCount - 1)];
+    Slot* victim = &bucket.slots[0];
+    int victimWorth = 1 << 30;
+
+    for (auto& slot : bucket.slots) {
+        uint64_t data = slot.data.load(std::memory_order_relaxed);
+        uint64_t check = slot.check.load(std::memory_order_relaxed);
+        if ((check ^ data) == key || data == 0) {
+            if ((check ^ data) == key && moveIndex == NO_TT_MOVE) {
+                moveIndex = static_cast<int>((data >> 26) & 0xFF);
+            }
+            victim = &slot;
+            break;
+        }
+        // Prefer to overwrite shallow entries left over from older searches.
+        int age = static_cast<int>((generation - unpackGeneration(data)) & 0xFF);
+        int worth = unpackDepth(data) - 4 * age;
+        if (worth < victimWorth) {
+            victimWorth = worth;
+            victim = &slot;
+        }
+    }
+
+    uint64_t data = pack(score, depth, bound, moveIndex, generation);
+    victim->data.store(data, std::memory_order_relaxed);
+    victim->check.store(key ^ data, std::memory_order_relaxed);
+}
+
+int TranspositionTable::hashfull() const {
+    size_t sample = bucketCount < 250 ? bucketCount : 250;
+    int used = 0;
+    for (size_t i = 0; i < sample; ++i) {
+        for (const auto& slot : buckets[i].slots) {
+            uint64_t data = slot.data.load(std::memory_order_relaxed);
+            if (data != 0 && unpackGeneration(data) == generation) ++used;
+        }
+    }
+    return static_cast<int>(used * 1000 / (sample * BUCKET_SIZE));
+}
@@ -0,0 +1,55 @@
+#ifndef TT_H
+#define TT_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+enum class Bound : uint8_t { None, Upper, Lower, Exact };
+
+const int NO_TT_MOVE = 0xFF;
+
+struct TTEntry {
+    int score = 0;
+    int depth = 0;
+    Bound bound = Bound::None;
+    int moveIndex = NO_TT_MOVE;    // index into the deterministic move list
+};
+
+// Fixed-size hash table of four-entry buckets. Each slot stores key ^ data next
+// to data, so a torn write from a concurrent store is rejected on probe
+// instead of needing a lock.
+class TranspositionTable {
+public:
+    explicit TranspositionTable(size_t megabytes = 16);
+
+    void resize(size_t megabytes);
+    void clear();
+    void newSearch() { generation = (generation + 1) & 0xFF; }
+
+    bool probe(uint64_t key, TTEntry& entry) const;
+    void store(uint64_t key, int score, int depth, Bound bound, int moveIndex);
+
+    size_t sizeMegabytes() const { return megabytes; }
+    int hashfull() const;
+
+private:
+    struct Slot {
+        std::atomic<uint64_t> check{0};
+        std::atomic<uint64_t> data{0};
+    };
+
+    static const int BUCKET_SIZE = 4;
+
+    struct alignas(64) Bucket {
+        Slot slots[BUCKET_SIZE];
+    };
+
+    std::unique_ptr<Bucket[]> buckets;
+    size_t bucketCount = 0;
+    size_t megabytes = 0;
+    uint32_t generation = 0;
+};
+
+#endif // TT_H
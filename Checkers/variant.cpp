@@ -0,0 +1,136 @@
+#include "variant.h"
+
+#include <utility>
+
+#include "game_state.h"
+#include "rules.h"
+
+namespace {
+
+template <typename MoveType>
+bool samePath(const MoveType& move, const VariantMove& wanted) {
+    if (move.from != wanted.from || move.pathLength != wanted.pathLength) return false;
+    for (int i = 0; i < move.pathLength; ++i) {
+        if (move.path[i] != wanted.path[i]) return false;
+    }
+    return true;
+}
+
+template <typename Geometry>
+class GeometryVariant : public Variant {
+public:
+    explicit GeometryVariant(const char* variantName) : variantName(variantName) {}
+
+    const char* name() const override { return variantName; }
+    int boardSize() const override { return Geometry::SIZE; }
+    int squareCount() const override { return Geometry::SQUARES; }
+    int squareRow(int sq) const override { return Geometry::row(sq); }
+    int squareCol(int sq) const override { return Geometry::col(sq); }
+    int squareIndex(int row, int col) const override { return Geometry::index(row, col); }
+
+private:
+    const char* variantName;
+};
+
+template <typename Rules>
+class RuleSetVariant : public GeometryVariant<typename Rules::GeometryType> {
+public:
+    typedef typename Rules::PositionType PositionType;
+    typedef typename Rules::MoveType MoveType;
+    typedef typename Rules::MoveListType MoveListType;
+    typedef typename Rules::UndoType UndoType;
+
+    explicit RuleSetVariant(const char* variantName)
+        : GeometryVariant<typename Rules::GeometryType>(variantName), pos(PositionType::initial()) {}
+
+    void reset() override {
+        pos = PositionType::initial();
+        history.clear();
+    }
+
+    PieceColor sideToMove() const override { return pos.sideToMove; }
+    Piece pieceAt(int sq) const override { return pos.pieceAt(sq); }
+    uint64_t capturers() const override { return Rules::capturers(pos); }
+
+    void generateMoves(std::vector<VariantMove>& moves) const override {
+        MoveListType list;
+        Rules::generateMoves(pos, list);
+        moves.clear();
+        for (const auto& move : list) moves.push_back(toVariantMove(move));
+    }
+
+    void makeMove(const VariantMove& wanted) override {
+        MoveListType list;
+        Rules::generateMoves(pos, list);
+        for (const auto& move : list) {
+            if (!samePath(move, wanted)) continue;
+            UndoType undo;
+            Rules::makeMove(pos, move, undo);
+            history.push_back(std::make_pair(move, undo));
+            return;
+        }
+    }
+
+    void unmakeMove() override {
+        if (history.empty()) return;
+        Rules::unmakeMove(pos, history.back().first, history.back().second);
+        history.pop_back();
+    }
+
+    int ply() const override { return static_cast<int>(history.size()); }
+    VariantMove moveAt(int ply) const override { return toVariantMove(history[ply].first); }
+
+private:
+    PositionType pos;
+    std::vector<std::pair<MoveType, UndoType>> history;
+};
+
+// Russian draughts goes through GameState so the engine can share the game.
+class RussianVariant : public GeometryVariant<StandardBoard> {
+public:
+    RussianVariant() : GeometryVariant<StandardBoard>("russian") {}
+
+    void reset() override { game.reset(Position::initial()); }
+    PieceColor sideToMove() const override { return game.sideToMove(); }
+    Piece pieceAt(int sq) const override { return game.position().pieceAt(sq); }
+    uint64_t capturers() const override { return game.capturers(); }
+
+    void generateMoves(std::vector<VariantMove>& moves) const override {
+        MoveList list;
+        game.generateMoves(list);
+        moves.clear();
+        for (const auto& move : list) moves.push_back(toVariantMove(move));
+    }
+
+    void makeMove(const VariantMove& wanted) override {
+        MoveList list;
+        game.generateMoves(list);
+        for (const auto& move : list) {
+            if (samePath(move, wanted)) {
+                game.makeMove(move);
+                return;
+            }
+        }
+    }
+
+    void unmakeMove() override {
+        if (game.ply() > 0) game.unmakeMove();
+    }
+
+    int ply() const override { return game.ply(); }
+    VariantMove moveAt(int ply) const override { return toVariantMove(game.moveAt(ply)); }
+
+    GameState* engineGame() override { return &game; }
+
+private:
+    GameState game;
+};
+
+} // namespace
+
+std::unique_ptr<Variant> createVariant(const std::string& name) {
+    if (name == "russian") return std::unique_ptr<Variant>(new RussianVariant());
+    if (name == "international") return std::unique_ptr<Variant>(new RuleSetVariant<InternationalDraughts>("international"));
+    if (name == "english") return std::unique_ptr<Variant>(new RuleSetVariant<EnglishDraughts>("english"));
+    return nullptr;
+}
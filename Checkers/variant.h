@@ -0,0 +1,73 @@
+#ifndef VARIANT_H
+#define VARIANT_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "bitboard.h"
+
+class GameState;
+
+const int MAX_VARIANT_PATH = BoardGeometry<10>::MAX_CAPTURE_PATH;
+
+// A move of any variant with the board size erased, for the GUI.
+struct VariantMove {
+    int from = 0;
+    int to = 0;
+    int pathLength = 0;
+    int path[MAX_VARIANT_PATH] = {};
+    uint64_t captured = 0;
+    bool promotion = false;
+};
+
+template <typename MoveType>
+VariantMove toVariantMove(const MoveType& move) {
+    VariantMove result;
+    result.from = move.from;
+    result.to = move.to;
+    result.pathLength = move.pathLength;
+    for (int i = 0; i < move.pathLength; ++i) result.path[i] = move.path[i];
+    result.captured = move.captured;
+    result.promotion = move.promotion;
+    return result;
+}
+
+// One game of a variant chosen at run time. Each implementation keeps its
+// rule set's compile-time specialized generator underneath; only the GUI
+// goes through the virtual calls.
+class Variant {
+public:
+    virtual ~Variant() {}
+
+    virtual const char* name() const = 0;
+    virtual int boardSize() const = 0;
+    virtual int squareCount() const = 0;
+    virtual int squareRow(int sq) const = 0;
+    virtual int squareCol(int sq) const = 0;
+    // -1 for light squares and squares off the board.
+    virtual int squareIndex(int row, int col) const = 0;
+
+    virtual void reset() = 0;
+    virtual PieceColor sideToMove() const = 0;
+    virtual Piece pieceAt(int sq) const = 0;
+    virtual uint64_t capturers() const = 0;
+    virtual void generateMoves(std::vector<VariantMove>& moves) const = 0;
+    // `move` must be one of generateMoves(); it is matched by its path.
+    virtual void makeMove(const VariantMove& move) = 0;
+    virtual void unmakeMove() = 0;
+    virtual int ply() const = 0;
+    virtual VariantMove moveAt(int ply) const = 0;
+
+    // The game the engine, opening book and analysis work on; null for the
+    // variants they do not know, which are played human against human.
+    virtual GameState* engineGame() { return nullptr; }
+};
+
+const char* const VARIANT_NAMES[] = {"russian", "international", "english"};
+
+// Null for an unknown name.
+std::unique_ptr<Variant> createVariant(const std::string& name);
+
+#endif // VARIANT_H
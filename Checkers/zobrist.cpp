@@ -0,0 +1,43 @@
+#include "zobrist.h"
+
+namespace {
+
+uint64_t splitMix64(uint64_t& state) {
+    uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+ZobristKeys makeKeys() {
+    ZobristKeys keys;
+    uint64_t state = 0x436865636B657273ull;
+    for (auto& piece : keys.pieces) {
+        for (auto& key : piece) key = splitMix64(state);
+    }
+    keys.blackToMove = splitMix64(state);
+    return keys;
+}
+
+uint64_t hashPieces(Bitboard pieces, const uint64_t* keys) {
+    uint64_t hash = 0;
+    while (pieces) hash ^= keys[popLowest(pieces)];
+    return hash;
+}
+
+} // namespace
+
+const ZobristKeys& zobristKeys() {
+    static const ZobristKeys keys = makeKeys();
+    return keys;
+}
+
+uint64_t hashPosition(const Position& pos) {
+    const ZobristKeys& keys = zobristKeys();
+    uint64_t hash = hashPieces(pos.white & ~pos.kings, keys.pieces[WhiteMan]) ^
+                    hashPieces(pos.white & pos.kings, keys.pieces[WhiteKing]) ^
+                    hashPieces(pos.black & ~pos.kings, keys.pieces[BlackMan]) ^
+                    hashPieces(pos.black & pos.kings, keys.pieces[BlackKing]);
+    if (pos.sideToMove == PieceColor::Black) hash ^= keys.blackToMove;
+    return hash;
+}
@@ -0,0 +1,18 @@
+#ifndef ZOBRIST_H
+#define ZOBRIST_H
+
+#include <cstdint>
+
+#include "bitboard.h"
+
+enum ZobristPiece { WhiteMan, WhiteKing, BlackMan, BlackKing, ZOBRIST_PIECES };
+
+struct ZobristKeys {
+    uint64_t pieces[ZOBRIST_PIECES][NUM_SQUARES];
+    uint64_t blackToMove;
+};
+
+const ZobristKeys& zobristKeys();
+uint64_t hashPosition(const Position& pos);
+
+#endif // ZOBRIST_H
@@ -1,7 +1,49 @@
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
 #include "checkers.h"
+#include "profiler.h"
+
+int main(int argc, char* argv[]) {
+    // The variant fixes the board before the window opens.
+    std::string variantName = "russian";
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (std::string(argv[i]) == "--variant") variantName = argv[i + 1];
+    }
+    if (!createVariant(variantName)) {
+        std::cerr << "unknown variant " << variantName << ", expected russian, international or english" << std::endl;
+        return 1;
+    }
+
+    CheckersGame game(variantName);
+    int moveTimeMs = 1000;
+    size_t hashMegabytes = 64;
+    int threads = 1;
+    std::string tracePath;
 
-int main() {
-    CheckersGame game;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string option = argv[i];
+        std::string value = argv[i + 1];
+        PlayerType player = value == "computer" ? PlayerType::Computer
+                          : value == "mcts"   ? PlayerType::Mcts
+                                              : PlayerType::Human;
+
+        if (option == "--white") game.setPlayer(PieceColor::White, player);
+        else if (option == "--black") game.setPlayer(PieceColor::Black, player);
+        else if (option == "--movetime") moveTimeMs = std::atoi(value.c_str());
+        else if (option == "--hash") hashMegabytes = std::strtoul(value.c_str(), nullptr, 10);
+        else if (option == "--threads") threads = std::atoi(value.c_str());
+        else if (option == "--trace") tracePath = value;
+        else if (option == "--book" && !game.setOpeningBook(value)) std::cerr << "cannot open book " << value << std::endl;
+    }
+
+    game.setEngineOptions(moveTimeMs, hashMegabytes, threads);
     game.run();
+
+    if (!tracePath.empty()) {
+        std::cout << profileSummary();
+        if (profilingEnabled() && !writeChromeTrace(tracePath)) std::cerr << "cannot write trace " << tracePath << std::endl;
+    }
     return 0;
 }
@@ -0,0 +1,297 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "bitboard.h"
+#include "game_state.h"
+#include "notation.h"
+#include "zobrist.h"
+
+#ifdef CHECKERS_BENCH_RENDER
+#include "checkers.h"
+#endif
+
+// Microbenchmarks of the hot paths the GUI and engine sit on, run over a
+// fixed corpus and compared against a stored baseline. Every benchmark
+// reports the best of several samples, which is far steadier than the mean
+// on a loaded machine.
+
+namespace {
+
+// Initial position, engine self-play middlegames (as in tools/scaling) and
+// king endings; the corpus is these plus every position one move after them.
+const char* const BENCH_POSITIONS[] = {
+    "W:Wa1,c1,e1,g1,b2,d2,f2,h2,a3,c3,e3,g3:Bb6,d6,f6,h6,a7,c7,e7,g7,b8,d8,f8,h8",
+    "B:Wg1,e1,c1,a1,h2,f2,d2,g3,c3,a3,d4,a5:Bh4,e5,h6,b6,g7,e7,c7,a7,h8,f8,d8,b8",
+    "B:Wg1,e1,a1,h2,f2,b2,g3,c3,a3,g5,a5:Bh4,h6,d6,b6,g7,c7,a7,h8,d8,b8",
+    "B:Wg1,a1,h2,f2,b2,e3,a3,f4,b4,a5:Bg5,c5,h6,f6,d6,c7,a7,h8,d8,b8",
+    "B:Wg1,a1,f2,g3,e3,a3,f4,b4,a5:Bh4,e5,c5,h6,d6,b6,c7,a7,h8",
+    "W:WKc3,Ke1,a3,b2:BKf8,Kh6,b6,d6",
+    "W:WKd4,Kg1:BKa7,Kh8,c7",
+    "B:WKa1,c3,e3,g3,f2:BKh8,Ke7,b6,d6",
+};
+
+const int SAMPLES = 15;
+const double MIN_SAMPLE_SECONDS = 0.02;
+const double DEFAULT_THRESHOLD = 0.25;
+// A benchmark over the threshold is measured again this many times and only
+// fails if every run is slow, since a busy machine slows whole runs down.
+const int CONFIRM_RUNS = 2;
+
+struct Corpus {
+    std::vector<Position> positions;
+    std::vector<std::vector<Move>> moves;
+    std::vector<GameState> states;
+};
+
+// A pass runs one operation per corpus item and returns how many it ran;
+// results go into `sink` so the work cannot be optimized away.
+struct Benchmark {
+    std::string name;
+    std::function<uint64_t(uint64_t& sink)> pass;
+};
+
+struct BenchResult {
+    std::string name;
+    uint64_t ops = 0;
+    double nsPerOp = 0;
+};
+
+void printUsage() {
+    std::cout << "usage: checkers_bench [--json FILE] [--baseline FILE] [--threshold FRACTION]\n"
+              << "  --json       write the results, in the format --baseline reads\n"
+              << "  --baseline   fail if a benchmark is slower than this file allows\n"
+              << "  --threshold  allowed slowdown over the baseline (default 0.25 = 25%)\n";
+}
+
+bool buildCorpus(Corpus& corpus) {
+    for (const char* fen : BENCH_POSITIONS) {
+        Position pos;
+        if (!parseFen(fen, pos)) {
+            std::cerr << "bad bench position: " << fen << std::endl;
+            return false;
+        }
+        corpus.positions.push_back(pos);
+        MoveList moves;
+        generateMoves(pos, moves);
+        for (const auto& move : moves) {
+            Position next = pos;
+            makeMove(next, move);
+            corpus.positions.push_back(next);
+        }
+    }
+    for (const auto& pos : corpus.positions) {
+        MoveList moves;
+        generateMoves(pos, moves);
+        corpus.moves.emplace_back(moves.begin(), moves.end());
+        corpus.states.emplace_back(pos);
+    }
+    return true;
+}
+
+std::vector<Benchmark> coreBenchmarks(Corpus& corpus) {
+    std::vector<Benchmark> benchmarks;
+    benchmarks.push_back({"generate_moves", [&corpus](uint64_t& sink) {
+        MoveList moves;
+        for (const auto& pos : corpus.positions) {
+            generateMoves(pos, moves);
+            sink += moves.size();
+        }
+        return static_cast<uint64_t>(corpus.positions.size());
+    }});
+    // What the GUI's mandatory-capture check and every search node ask first.
+    benchmarks.push_back({"mandatory_capture", [&corpus](uint64_t& sink) {
+        for (const auto& pos : corpus.positions) sink += capturers(pos);
+        return static_cast<uint64_t>(corpus.positions.size());
+    }});
+    benchmarks.push_back({"make_unmake", [&corpus](uint64_t& sink) {
+        uint64_t ops = 0;
+        for (size_t i = 0; i < corpus.positions.size(); ++i) {
+            Position pos = corpus.positions[i];
+            for (const auto& move : corpus.moves[i]) {
+                UndoInfo undo;
+                makeMove(pos, move, undo);
+                sink += pos.kings;
+                unmakeMove(pos, move, undo);
+            }
+            ops += corpus.moves[i].size();
+        }
+        return ops;
+    }});
+    // A finished GUI move: GameState keeps counts, key and mobility current.
+    benchmarks.push_back({"game_state_move", [&corpus](uint64_t& sink) {
+        uint64_t ops = 0;
+        for (size_t i = 0; i < corpus.states.size(); ++i) {
+            GameState& state = corpus.states[i];
+            for (const auto& move : corpus.moves[i]) {
+                state.makeMove(move);
+                sink += state.hash();
+                state.unmakeMove();
+            }
+            ops += corpus.moves[i].size();
+        }
+        return ops;
+    }});
+    benchmarks.push_back({"win_detection", [&corpus](uint64_t& sink) {
+        for (const auto& pos : corpus.positions) sink += capturers(pos) == 0 && movers(pos) == 0;
+        return static_cast<uint64_t>(corpus.positions.size());
+    }});
+    benchmarks.push_back({"hash_position", [&corpus](uint64_t& sink) {
+        for (const auto& pos : corpus.positions) sink += hashPosition(pos);
+        return static_cast<uint64_t>(corpus.positions.size());
+    }});
+    return benchmarks;
+}
+
+BenchResult measure(const Benchmark& benchmark, uint64_t& sink) {
+    BenchResult result;
+    result.name = benchmark.name;
+    benchmark.pass(sink);   // warm-up
+    for (int sample = 0; sample < SAMPLES; ++sample) {
+        uint64_t ops = 0;
+        double seconds = 0;
+        auto start = std::chrono::steady_clock::now();
+        while (seconds < MIN_SAMPLE_SECONDS) {
+            ops += benchmark.pass(sink);
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            seconds = elapsed.count();
+        }
+        double nsPerOp = seconds * 1e9 / ops;
+        if (sample == 0 || nsPerOp < result.nsPerOp) {
+            result.nsPerOp = nsPerOp;
+            result.ops = ops;
+        }
+    }
+    return result;
+}
+
+bool writeJson(const std::string& path, const std::vector<BenchResult>& results) {
+    std::ofstream out(path);
+    if (!out) return false;
+    out << "{\n  \"benchmarks\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        char nsPerOp[32];
+        std::snprintf(nsPerOp, sizeof(nsPerOp), "%.3f", results[i].nsPerOp);
+        out << "    {\"name\": \"" << results[i].name << "\", \"ops\": " << results[i].ops
+            << ", \"ns_per_op\": " << nsPerOp << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+    return static_cast<bool>(out);
+}
+
+// Reads back what writeJson produces: every "name" paired with the
+// "ns_per_op" that follows it.
+bool readBaseline(const std::string& path, std::map<std::string, double>& baseline) {
+    std::ifstream in(path);
+    if (!in) return false;
+    std::stringstream buffer;
+    buffer << in.rdbuf();
+    std::string text = buffer.str();
+
+    const std::string nameKey = "\"name\": \"";
+    const std::string valueKey = "\"ns_per_op\": ";
+    size_t pos = 0;
+    while ((pos = text.find(nameKey, pos)) != std::string::npos) {
+        size_t nameStart = pos + nameKey.size();
+        size_t nameEnd = text.find('"', nameStart);
+        size_t value = text.find(valueKey, nameEnd);
+        if (nameEnd == std::string::npos || value == std::string::npos) return false;
+        baseline[text.substr(nameStart, nameEnd - nameStart)] = std::strtod(text.c_str() + value + valueKey.size(), nullptr);
+        pos = value;
+    }
+    return !baseline.empty();
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::string jsonPath;
+    std::string baselinePath;
+    double threshold = DEFAULT_THRESHOLD;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--json" && i + 1 < argc) jsonPath = argv[++i];
+        else if (arg == "--baseline" && i + 1 < argc) baselinePath = argv[++i];
+        else if (arg == "--threshold" && i + 1 < argc) threshold = std::atof(argv[++i]);
+        else {
+            printUsage();
+            return arg == "--help" ? 0 : 2;
+        }
+    }
+
+    std::map<std::string, double> baseline;
+    if (!baselinePath.empty() && !readBaseline(baselinePath, baseline)) {
+        std::cerr << "cannot read baseline " << baselinePath << std::endl;
+        return 2;
+    }
+
+    Corpus corpus;
+    if (!buildCorpus(corpus)) return 1;
+    std::vector<Benchmark> benchmarks = coreBenchmarks(corpus);
+
+#ifdef CHECKERS_BENCH_RENDER
+    CheckersGame game("russian", false);
+    sf::RenderTexture texture;
+    if (texture.create(WINDOW_SIZE, WINDOW_SIZE)) {
+        benchmarks.push_back({"render_frame", [&game, &texture](uint64_t&) {
+            game.renderTo(texture);
+            texture.display();
+            return uint64_t(1);
+        }});
+    } else {
+        std::cout << "render_frame skipped: no offscreen rendering context" << std::endl;
+    }
+#endif
+
+    std::cout << corpus.positions.size() << " positions, best of " << SAMPLES << " samples\n";
+    std::printf("%-20s %12s %12s %9s\n", "benchmark", "ns/op", "baseline", "change");
+
+    uint64_t sink = 0;
+    std::vector<BenchResult> results;
+    std::vector<std::string> regressions;
+    for (const auto& benchmark : benchmarks) {
+        results.push_back(measure(benchmark, sink));
+        BenchResult& result = results.back();
+
+        auto expected = baseline.find(result.name);
+        if (expected == baseline.end() || expected->second <= 0) {
+            std::printf("%-20s %12.2f %12s %9s\n", result.name.c_str(), result.nsPerOp, "-", "new");
+            continue;
+        }
+        double change = result.nsPerOp / expected->second - 1;
+        for (int run = 0; run < CONFIRM_RUNS && change > threshold; ++run) {
+            BenchResult again = measure(benchmark, sink);
+            if (again.nsPerOp < result.nsPerOp) result = again;
+            change = result.nsPerOp / expected->second - 1;
+        }
+        bool slower = change > threshold;
+        if (slower) regressions.push_back(result.name);
+        std::printf("%-20s %12.2f %12.2f %+8.1f%%%s\n", result.name.c_str(), result.nsPerOp, expected->second,
+                    change * 100, slower ? "  SLOWER" : "");
+    }
+    // Keeps the sink alive; it is not meaningful otherwise.
+    if (sink == 1) std::cout << std::endl;
+
+    if (!jsonPath.empty() && !writeJson(jsonPath, results)) {
+        std::cerr << "cannot write " << jsonPath << std::endl;
+        return 1;
+    }
+
+    if (!regressions.empty()) {
+        std::cout << "FAILED: " << regressions.size() << " benchmark(s) more than " << threshold * 100
+                  << "% slower than " << baselinePath << ":";
+        for (const auto& name : regressions) std::cout << " " << name;
+        std::cout << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,120 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "notation.h"
+#include "opening_book.h"
+#include "pdn.h"
+
+namespace {
+
+void printUsage() {
+    std::cout << "usage: book build GAMES.pdn --out BOOK [--max-ply N] [--min-games N] [--threads N]\n"
+              << "       book probe BOOK [--fen FEN | --moves \"c3-d4 ...\"]\n";
+}
+
+double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+bool playMoves(const std::string& moves, Position& pos) {
+    std::stringstream stream(moves);
+    std::string token;
+    while (stream >> token) {
+        Move move;
+        if (!parseMove(pos, token, move)) return false;
+        makeMove(pos, move);
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        printUsage();
+        return 2;
+    }
+    std::string command = argv[1];
+    std::string path = argv[2];
+    std::string outPath;
+    std::string fen;
+    std::string moves;
+    OpeningBookOptions options;
+
+    for (int i = 3; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--out" && hasValue) outPath = argv[++i];
+        else if (arg == "--max-ply" && hasValue) options.maxPly = std::atoi(argv[++i]);
+        else if (arg == "--min-games" && hasValue) options.minGames = std::atoi(argv[++i]);
+        else if (arg == "--threads" && hasValue) options.threads = std::atoi(argv[++i]);
+        else if (arg == "--fen" && hasValue) fen = argv[++i];
+        else if (arg == "--moves" && hasValue) moves = argv[++i];
+        else {
+            printUsage();
+            return 2;
+        }
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    if (command == "build") {
+        PdnDatabase games;
+        if (outPath.empty() || !games.open(path)) {
+            printUsage();
+            return 2;
+        }
+        OpeningBookStats stats;
+        if (!buildOpeningBook(games, outPath, options, &stats)) {
+            std::cerr << "cannot write " << outPath << std::endl;
+            return 1;
+        }
+        std::cout << stats.games.games << " games (" << stats.games.invalidGames << " invalid) -> "
+                  << stats.positions << " positions, " << stats.moves << " moves in "
+                  << secondsSince(start) << " s" << std::endl;
+        return 0;
+    }
+
+    if (command != "probe") {
+        printUsage();
+        return 2;
+    }
+
+    OpeningBook book;
+    if (!book.open(path)) {
+        std::cerr << "cannot open book " << path << std::endl;
+        return 1;
+    }
+    double openSeconds = secondsSince(start);
+
+    Position pos = Position::initial();
+    if ((!fen.empty() && !parseFen(fen, pos)) || !playMoves(moves, pos)) {
+        std::cerr << "bad --fen or --moves" << std::endl;
+        return 2;
+    }
+
+    start = std::chrono::steady_clock::now();
+    std::vector<BookMove> entries;
+    bool found = book.probe(pos, entries);
+    double probeSeconds = secondsSince(start);
+
+    std::cout << book.positionCount() << " positions, opened in " << openSeconds * 1000 << " ms, probe "
+              << probeSeconds * 1e6 << " us" << std::endl;
+    if (!found) {
+        std::cout << "out of book" << std::endl;
+        return 0;
+    }
+    for (const auto& entry : entries) {
+        uint32_t games = entry.wins + entry.draws + entry.losses;
+        char line[128];
+        std::snprintf(line, sizeof(line), "%-12s weight %6u  +%u =%u -%u  %.1f%%",
+                      moveToString(entry.move).c_str(), entry.weight, entry.wins, entry.draws, entry.losses,
+                      games ? 100.0 * (entry.wins + 0.5 * entry.draws) / games : 0.0);
+        std::cout << line << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,396 @@
+#include <algorithm>
+#include <cctype>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "game_state.h"
+#include "notation.h"
+#include "opening_book.h"
+#include "search.h"
+#include "tablebase.h"
+
+// Line-based engine protocol in the style of Hub: every line is a command
+// word followed by bare words and key=value pairs, values with spaces being
+// double-quoted. Positions are FEN and moves algebraic, as elsewhere in the
+// project. The search runs on its own thread so that stop and ponder-hit are
+// answered while it thinks.
+//
+//   hub                               -> id, param..., wait
+//   init                              -> ready
+//   set-param name=hash|threads|book|tb-path value=V
+//   new-game
+//   pos [pos=FEN] [moves="c3-d4 f6-g5"]
+//   level [depth=N] [nodes=N] [move-time=S] [time=S] [inc=S] [moves=N] [infinite]
+//   go think|ponder|analyze           -> info..., done move=M [ponder=M]
+//   ponder-hit | stop | ping (-> pong) | quit
+
+namespace {
+
+const char* const ENGINE_NAME = "Checkers";
+const char* const ENGINE_VERSION = "1.0";
+const int DEFAULT_MOVES_TO_GO = 30;
+const int TIME_MARGIN_MS = 50;
+
+struct Command {
+    std::string name;
+    std::vector<std::string> words;
+    std::map<std::string, std::string> args;
+
+    bool has(const std::string& word) const {
+        return std::find(words.begin(), words.end(), word) != words.end();
+    }
+    std::string arg(const std::string& key, const std::string& fallback = "") const {
+        auto it = args.find(key);
+        return it == args.end() ? fallback : it->second;
+    }
+};
+
+bool parseCommand(const std::string& line, Command& command) {
+    size_t i = 0;
+    bool first = true;
+    while (true) {
+        while (i < line.size() && std::isspace(static_cast<unsigned char>(line[i]))) ++i;
+        if (i == line.size()) break;
+
+        std::string key;
+        while (i < line.size() && line[i] != '=' && !std::isspace(static_cast<unsigned char>(line[i]))) {
+            key += line[i++];
+        }
+        if (i == line.size() || line[i] != '=') {
+            if (first) command.name = key;
+            else command.words.push_back(key);
+            first = false;
+            continue;
+        }
+        if (first) return false;
+
+        std::string value;
+        if (++i < line.size() && line[i] == '"') {
+            size_t end = line.find('"', ++i);
+            if (end == std::string::npos) return false;
+            value = line.substr(i, end - i);
+            i = end + 1;
+        } else {
+            while (i < line.size() && !std::isspace(static_cast<unsigned char>(line[i]))) value += line[i++];
+        }
+        command.args[key] = value;
+    }
+    return !command.name.empty();
+}
+
+std::string quote(const std::string& value) {
+    return value.find(' ') == std::string::npos && !value.empty() ? value : "\"" + value + "\"";
+}
+
+// The search thread and the command loop both write to stdout.
+std::mutex outputMutex;
+
+void send(const std::string& line) {
+    std::lock_guard<std::mutex> lock(outputMutex);
+    std::cout << line << std::endl;
+}
+
+void sendError(const std::string& message) {
+    send("error message=" + quote(message));
+}
+
+int secondsToMs(const std::string& value) {
+    return static_cast<int>(std::atof(value.c_str()) * 1000);
+}
+
+enum class GoMode { Think, Ponder, Analyze };
+
+class HubEngine {
+public:
+    HubEngine() : engine(hashMegabytes, threads), random(std::random_device{}()) {}
+
+    bool handle(const Command& command);
+
+private:
+    struct Level {
+        int depth = MAX_DEPTH;
+        uint64_t nodes = 0;
+        int moveTimeMs = 1000;
+        int timeMs = 0;         // remaining clock time, 0 when not playing on a clock
+        int incrementMs = 0;
+        int movesToGo = 0;
+        bool infinite = false;
+    };
+
+    void sendIdentity() const;
+    void setParam(const Command& command);
+    void setPosition(const Command& command);
+    void setLevel(const Command& command);
+    int thinkTimeMs() const;
+
+    void go(GoMode mode);
+    void searchThread(Position pos, SearchLimits limits);
+    void ponderHit();
+    void stopSearch();
+
+    size_t hashMegabytes = 64;
+    int threads = 1;
+    Engine engine;
+    std::unique_ptr<Tablebase> tablebase;
+    OpeningBook book;
+    std::mt19937_64 random;
+    GameState game;
+    Level level;
+
+    std::thread worker;
+    std::mutex searchMutex;
+    std::condition_variable searchSignal;
+    bool started = false;       // the engine has set up its limits
+    bool holdResult = false;    // pondering or analysing: report only once told to
+    bool pondering = false;
+};
+
+void HubEngine::sendIdentity() const {
+    send(std::string("id name=") + ENGINE_NAME + " version=" + ENGINE_VERSION);
+    send("param name=hash value=" + std::to_string(hashMegabytes) + " type=int min=1 max=65536");
+    send("param name=threads value=" + std::to_string(threads) + " type=int min=1 max=256");
+    send("param name=book value=\"\" type=string");
+    send("param name=tb-path value=\"\" type=string");
+    send("wait");
+}
+
+void HubEngine::setParam(const Command& command) {
+    std::string name = command.arg("name");
+    std::string value = command.arg("value");
+    if (name == "hash") {
+        hashMegabytes = std::max(1ul, std::strtoul(value.c_str(), nullptr, 10));
+        engine.setHashSize(hashMegabytes);
+    } else if (name == "threads") {
+        threads = std::max(1, std::atoi(value.c_str()));
+        engine.setThreads(threads);
+    } else if (name == "book") {
+        book.close();
+        if (!value.empty() && !book.open(value)) sendError("cannot open book " + value);
+    } else if (name == "tb-path") {
+        engine.setTablebase(nullptr);
+        tablebase.reset();
+        if (value.empty()) return;
+        tablebase.reset(new Tablebase());
+        if (tablebase->load(value, MAX_TABLEBASE_PIECES) == 0) {
+            tablebase.reset();
+            sendError("no tablebase files in " + value);
+            return;
+        }
+        engine.setTablebase(tablebase.get());
+    } else {
+        sendError("unknown parameter " + name);
+    }
+}
+
+void HubEngine::setPosition(const Command& command) {
+    Position pos = Position::initial();
+    std::string fen = command.arg("pos");
+    if (!fen.empty() && !parseFen(fen, pos)) {
+        sendError("bad position " + fen);
+        return;
+    }
+    GameState next(pos);
+    std::string moves = command.arg("moves");
+    size_t i = 0;
+    while (i < moves.size()) {
+        size_t end = moves.find(' ', i);
+        if (end == std::string::npos) end = moves.size();
+        if (end > i) {
+            Move move;
+            if (!parseMove(next.position(), moves.data() + i, end - i, move)) {
+                sendError("illegal move " + moves.substr(i, end - i));
+                return;
+            }
+            next.makeMove(move);
+        }
+        i = end + 1;
+    }
+    game = next;
+}
+
+void HubEngine::setLevel(const Command& command) {
+    level = Level();
+    level.moveTimeMs = 0;
+    level.infinite = command.has("infinite");
+    if (command.args.count("depth")) level.depth = std::max(1, std::min(MAX_DEPTH, std::atoi(command.arg("depth").c_str())));
+    if (command.args.count("nodes")) level.nodes = std::strtoull(command.arg("nodes").c_str(), nullptr, 10);
+    if (command.args.count("move-time")) level.moveTimeMs = std::max(1, secondsToMs(command.arg("move-time")));
+    if (command.args.count("time")) level.timeMs = std::max(1, secondsToMs(command.arg("time")));
+    if (command.args.count("inc")) level.incrementMs = secondsToMs(command.arg("inc"));
+    if (command.args.count("moves")) level.movesToGo = std::atoi(command.arg("moves").c_str());
+    if (!level.infinite && level.depth == MAX_DEPTH && level.nodes == 0 && level.timeMs == 0 &&
+        level.moveTimeMs == 0) {
+        level.infinite = true;
+    }
+}
+
+// Budget for one move: a fixed move time, or an even share of the clock that
+// never spends more than half of what is left.
+int HubEngine::thinkTimeMs() const {
+    if (level.infinite) return 0;
+    if (level.moveTimeMs > 0) return level.moveTimeMs;
+    if (level.timeMs == 0) return 0;
+
+    int movesToGo = level.movesToGo > 0 ? level.movesToGo : DEFAULT_MOVES_TO_GO;
+    int budget = level.timeMs / movesToGo + level.incrementMs * 3 / 4;
+    budget = std::min(budget, level.timeMs / 2);
+    return std::max(1, budget - TIME_MARGIN_MS);
+}
+
+void HubEngine::go(GoMode mode) {
+    stopSearch();
+
+    MoveList moves;
+    game.generateMoves(moves);
+    if (moves.empty()) {
+        send("done");
+        return;
+    }
+    Move bookMove;
+    if (mode == GoMode::Think && book.pickMove(game.position(), random(), bookMove)) {
+        send("done move=" + moveToString(bookMove));
+        return;
+    }
+
+    SearchLimits limits;
+    if (mode != GoMode::Analyze && !level.infinite) {
+        limits.depth = level.depth;
+        limits.nodes = level.nodes;
+        if (mode == GoMode::Think) limits.moveTimeMs = thinkTimeMs();
+    }
+    std::vector<uint64_t> history;
+    game.keyHistory(history);
+    engine.setGameHistory(history);
+
+    started = false;
+    holdResult = mode != GoMode::Think;
+    pondering = mode == GoMode::Ponder;
+    worker = std::thread(&HubEngine::searchThread, this, game.position(), limits);
+
+    // ponder-hit must not reach the engine before search() has reset its clock.
+    std::unique_lock<std::mutex> lock(searchMutex);
+    searchSignal.wait(lock, [this]() { return started; });
+}
+
+void HubEngine::searchThread(Position pos, SearchLimits limits) {
+    SearchResult result = engine.search(pos, limits, [this](const SearchResult& info) {
+        {
+            std::lock_guard<std::mutex> lock(searchMutex);
+            if (!started) {
+                started = true;
+                searchSignal.notify_all();
+            }
+        }
+        double seconds = std::max(info.seconds, 1e-6);
+        std::string line = "info depth=" + std::to_string(info.depth) + " score=" + std::to_string(info.score) +
+                           " nodes=" + std::to_string(info.nodes);
+        char numbers[64];
+        std::snprintf(numbers, sizeof(numbers), " time=%.3f nps=%.0f", info.seconds, info.nodes / seconds);
+        line += numbers;
+        std::string pv;
+        for (const auto& move : info.pv) pv += (pv.empty() ? "" : " ") + moveToString(move);
+        send(line + " pv=" + quote(pv));
+    });
+
+    std::unique_lock<std::mutex> lock(searchMutex);
+    started = true;
+    searchSignal.notify_all();
+    searchSignal.wait(lock, [this]() { return !holdResult; });
+    lock.unlock();
+
+    std::string line = "done move=" + moveToString(result.bestMove);
+    if (result.pv.size() > 1) line += " ponder=" + moveToString(result.pv[1]);
+    send(line);
+}
+
+// The opponent played the expected move: the ponder search carries on as a
+// normal search whose clock starts now.
+void HubEngine::ponderHit() {
+    {
+        std::lock_guard<std::mutex> lock(searchMutex);
+        if (!pondering) return;
+        pondering = false;
+        holdResult = false;
+    }
+    searchSignal.notify_all();
+    int budget = thinkTimeMs();
+    if (budget > 0) engine.ponderHit(budget);
+}
+
+void HubEngine::stopSearch() {
+    if (!worker.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(searchMutex);
+        pondering = false;
+        holdResult = false;
+    }
+    searchSignal.notify_all();
+    engine.stop();
+    worker.join();
+}
+
+// Returns false on quit.
+bool HubEngine::handle(const Command& command) {
+    const std::string& name = command.name;
+    if (name == "hub") {
+        sendIdentity();
+    } else if (name == "init") {
+        send("ready");
+    } else if (name == "ping") {
+        send("pong");
+    } else if (name == "set-param") {
+        stopSearch();
+        setParam(command);
+    } else if (name == "new-game") {
+        stopSearch();
+        engine.newGame();
+        game.reset(Position::initial());
+    } else if (name == "pos") {
+        stopSearch();
+        setPosition(command);
+    } else if (name == "level") {
+        setLevel(command);
+    } else if (name == "go") {
+        if (command.has("ponder")) go(GoMode::Ponder);
+        else if (command.has("analyze")) go(GoMode::Analyze);
+        else go(GoMode::Think);
+    } else if (name == "ponder-hit") {
+        ponderHit();
+    } else if (name == "stop") {
+        stopSearch();
+    } else if (name == "quit") {
+        stopSearch();
+        return false;
+    } else {
+        sendError("unknown command " + name);
+    }
+    return true;
+}
+
+} // namespace
+
+int main() {
+    std::ios::sync_with_stdio(false);
+    HubEngine hub;
+
+    std::string line;
+    while (std::getline(std::cin, line)) {
+        Command command;
+        if (!parseCommand(line, command)) {
+            if (line.find_first_not_of(" \t\r") != std::string::npos) sendError("malformed line");
+            continue;
+        }
+        if (!hub.handle(command)) return 0;
+    }
+    hub.handle(Command{"quit", {}, {}});
+    return 0;
+}
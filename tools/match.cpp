@@ -0,0 +1,386 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "notation.h"
+#include "opening_book.h"
+#include "pdn.h"
+#include "profiler.h"
+#include "search.h"
+#include "tablebase.h"
+#include "zobrist.h"
+
+// Headless engine-vs-engine match runner. Games are played in pairs from the
+// same randomized opening with colors swapped; every worker owns its game and
+// both engines, and only finished games cross threads through the sink.
+
+namespace {
+
+// Russian rules: 15 moves by each side with only kings moving and nothing
+// captured is a draw.
+const int KING_MOVE_DRAW_PLIES = 30;
+
+struct PlayerConfig {
+    std::string name;
+    SearchLimits limits;
+    size_t hashMegabytes = 16;
+    std::string bookPath;
+    OpeningBook book;
+};
+
+struct MatchOptions {
+    PlayerConfig players[2];
+    int games = 100;
+    int threads = 1;
+    int randomPlies = 4;
+    int maxPlies = 400;
+    uint64_t seed = 1;
+    std::string pdnPath;
+    std::string jsonlPath;
+    std::string tablebaseDirectory;
+};
+
+enum class Outcome { WhiteWin, BlackWin, Draw };
+
+struct GameRecord {
+    int index = 0;
+    int whitePlayer = 0;    // index into MatchOptions::players
+    Outcome outcome = Outcome::Draw;
+    std::string reason;
+    std::vector<Move> moves;
+    int openingPlies = 0;
+    uint64_t nodes = 0;
+    double seconds = 0;
+};
+
+void printUsage() {
+    std::cout << "usage: match [--games N] [--threads N] [--a SPEC] [--b SPEC] [--random-plies N]\n"
+              << "             [--max-plies N] [--seed N] [--pdn FILE] [--jsonl FILE] [--tb DIR] [--trace FILE]\n"
+              << "  SPEC is a comma separated list of name=X, movetime=MS, nodes=N, depth=N, hash=MB, book=FILE\n";
+}
+
+bool parsePlayer(const std::string& spec, PlayerConfig& player) {
+    std::stringstream stream(spec);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        size_t eq = item.find('=');
+        if (eq == std::string::npos) return false;
+        std::string key = item.substr(0, eq);
+        std::string value = item.substr(eq + 1);
+        if (key == "name") player.name = value;
+        else if (key == "movetime") player.limits.moveTimeMs = std::atoi(value.c_str());
+        else if (key == "nodes") player.limits.nodes = std::strtoull(value.c_str(), nullptr, 10);
+        else if (key == "depth") player.limits.depth = std::atoi(value.c_str());
+        else if (key == "hash") player.hashMegabytes = std::strtoul(value.c_str(), nullptr, 10);
+        else if (key == "book") player.bookPath = value;
+        else return false;
+    }
+    return true;
+}
+
+std::string resultString(Outcome outcome) {
+    switch (outcome) {
+    case Outcome::WhiteWin: return "2-0";
+    case Outcome::BlackWin: return "0-2";
+    default:                return "1-1";
+    }
+}
+
+// Both games of a pair replay the same random opening, derived from the seed
+// and the pair number only.
+std::vector<Move> randomOpening(const MatchOptions& options, int pair) {
+    std::mt19937_64 rng(options.seed * 0x9E3779B97F4A7C15ull + static_cast<uint64_t>(pair));
+    for (int attempt = 0; attempt < 100; ++attempt) {
+        Position pos = Position::initial();
+        std::vector<Move> line;
+        MoveList moves;
+        for (int ply = 0; ply < options.randomPlies; ++ply) {
+            generateMoves(pos, moves);
+            if (moves.empty()) break;
+            const Move& move = moves[rng() % moves.size()];
+            line.push_back(move);
+            makeMove(pos, move);
+        }
+        generateMoves(pos, moves);
+        if (!moves.empty()) return line;
+    }
+    return std::vector<Move>();
+}
+
+bool tablebaseAdjudication(const Tablebase* tablebase, const Position& pos, Outcome& outcome) {
+    if (!tablebase || popCount(pos.occupied()) > tablebase->maxPieces()) return false;
+    TablebaseResult result;
+    if (!tablebase->probe(pos, result) || result.value == TB_UNKNOWN) return false;
+
+    bool whiteToMove = pos.sideToMove == PieceColor::White;
+    if (result.value == TB_DRAW) outcome = Outcome::Draw;
+    else if ((result.value == TB_WIN) == whiteToMove) outcome = Outcome::WhiteWin;
+    else outcome = Outcome::BlackWin;
+    return true;
+}
+
+void playGame(const MatchOptions& options, const Tablebase* tablebase, Engine* engines[2], GameRecord& game) {
+    PROFILE_ZONE("playGame");
+    Position pos = Position::initial();
+    std::vector<uint64_t> history;
+    MoveList moves;
+    int kingMovePlies = 0;
+    std::mt19937_64 bookRng(options.seed ^ (static_cast<uint64_t>(game.index) << 32));
+
+    for (const auto& move : randomOpening(options, game.index / 2)) {
+        history.push_back(hashPosition(pos));
+        game.moves.push_back(move);
+        makeMove(pos, move);
+    }
+    game.openingPlies = static_cast<int>(game.moves.size());
+    engines[0]->newGame();
+    engines[1]->newGame();
+
+    while (true) {
+        // Same terminal rule as CheckersGame::checkWinCondition.
+        generateMoves(pos, moves);
+        if (moves.empty()) {
+            game.outcome = pos.sideToMove == PieceColor::White ? Outcome::BlackWin : Outcome::WhiteWin;
+            game.reason = "no legal moves";
+            return;
+        }
+
+        uint64_t key = hashPosition(pos);
+        if (std::count(history.begin(), history.end(), key) >= 2) {
+            game.reason = "threefold repetition";
+            return;
+        }
+        if (kingMovePlies >= KING_MOVE_DRAW_PLIES) {
+            game.reason = "king moves without capture";
+            return;
+        }
+        if (static_cast<int>(game.moves.size()) >= options.maxPlies) {
+            game.reason = "move limit";
+            return;
+        }
+        if (tablebaseAdjudication(tablebase, pos, game.outcome)) {
+            game.reason = "tablebase";
+            return;
+        }
+        history.push_back(key);
+
+        bool whiteToMove = pos.sideToMove == PieceColor::White;
+        int player = whiteToMove ? game.whitePlayer : 1 - game.whitePlayer;
+        Move move;
+        if (!options.players[player].book.pickMove(pos, bookRng(), move)) {
+            Engine& engine = *engines[player];
+            engine.setGameHistory(history);
+            SearchResult result = engine.search(pos, options.players[player].limits);
+            game.nodes += result.nodes;
+            game.seconds += result.seconds;
+            move = result.hasMove ? result.bestMove : moves.front();
+        }
+        bool kingMove = !move.isCapture() && (pos.kings & squareBit(move.from));
+        kingMovePlies = kingMove ? kingMovePlies + 1 : 0;
+        // Positions before a capture or man move cannot come back.
+        if (!kingMove) history.clear();
+
+        game.moves.push_back(move);
+        makeMove(pos, move);
+    }
+}
+
+std::string jsonEscape(const std::string& text) {
+    std::string out;
+    for (char c : text) {
+        if (c == '"' || c == '\\') out += '\\';
+        out += c;
+    }
+    return out;
+}
+
+// Collects finished games from all workers, streams them to the output files
+// and keeps the running score of player A.
+class ResultSink {
+public:
+    ResultSink(const MatchOptions& options) : options(options) {
+        if (!options.pdnPath.empty()) pdn.open(options.pdnPath);
+        if (!options.jsonlPath.empty()) jsonl.open(options.jsonlPath);
+    }
+
+    bool isOpen() const {
+        return (options.pdnPath.empty() || pdn.isOpen()) && (options.jsonlPath.empty() || jsonl.is_open());
+    }
+
+    void add(const GameRecord& game) {
+        std::lock_guard<std::mutex> lock(mutex);
+        const std::string& white = options.players[game.whitePlayer].name;
+        const std::string& black = options.players[1 - game.whitePlayer].name;
+
+        if (game.outcome == Outcome::Draw) ++draws;
+        else if ((game.outcome == Outcome::WhiteWin) == (game.whitePlayer == 0)) ++wins;
+        else ++losses;
+
+        if (pdn.isOpen()) {
+            PdnGame record;
+            record.setTag("Event", "match");
+            record.setTag("Round", std::to_string(game.index + 1));
+            record.setTag("White", white);
+            record.setTag("Black", black);
+            record.setTag("Termination", game.reason);
+            record.moves = game.moves;
+            record.result = resultString(game.outcome);
+            pdn.write(record);
+        }
+
+        if (jsonl.is_open()) {
+            jsonl << "{\"game\":" << game.index + 1
+                  << ",\"white\":\"" << jsonEscape(white) << "\",\"black\":\"" << jsonEscape(black) << "\""
+                  << ",\"result\":\"" << resultString(game.outcome) << "\""
+                  << ",\"reason\":\"" << game.reason << "\""
+                  << ",\"plies\":" << game.moves.size()
+                  << ",\"opening_plies\":" << game.openingPlies
+                  << ",\"nodes\":" << game.nodes
+                  << ",\"moves\":\"";
+            for (size_t i = 0; i < game.moves.size(); ++i) {
+                jsonl << (i ? " " : "") << moveToString(game.moves[i]);
+            }
+            jsonl << "\"}\n" << std::flush;
+        }
+
+        int played = wins + draws + losses;
+        std::cout << "game " << game.index + 1 << ": " << white << " - " << black << " "
+                  << resultString(game.outcome) << " (" << game.reason << ", " << game.moves.size()
+                  << " plies)  score " << wins << "-" << losses << "-" << draws
+                  << " [" << played << "/" << options.games << "]" << std::endl;
+    }
+
+    int wins = 0;
+    int draws = 0;
+    int losses = 0;
+
+private:
+    const MatchOptions& options;
+    std::mutex mutex;
+    PdnWriter pdn;
+    std::ofstream jsonl;
+};
+
+double eloFromScore(double score) {
+    return 400.0 * std::log10(score / (1.0 - score));
+}
+
+void printSummary(const MatchOptions& options, const ResultSink& sink, double seconds) {
+    int games = sink.wins + sink.draws + sink.losses;
+    if (games == 0) return;
+
+    double score = (sink.wins + 0.5 * sink.draws) / games;
+    double deviation = (sink.wins * std::pow(1.0 - score, 2) + sink.draws * std::pow(0.5 - score, 2) +
+                        sink.losses * std::pow(score, 2)) / games;
+    double margin = 1.96 * std::sqrt(deviation / games);
+    auto clamp = [](double value) { return std::min(std::max(value, 1e-3), 1.0 - 1e-3); };
+    double low = clamp(score - margin);
+    double high = clamp(score + margin);
+    double clamped = clamp(score);
+
+    char line[160];
+    std::cout << "\n" << options.players[0].name << " vs " << options.players[1].name << ": +"
+              << sink.wins << " =" << sink.draws << " -" << sink.losses << "\n";
+    std::snprintf(line, sizeof(line), "score %.1f%%  elo %+.1f  95%% [%+.1f, %+.1f]\n",
+                  100.0 * score, eloFromScore(clamped), eloFromScore(low), eloFromScore(high));
+    std::cout << line;
+    std::snprintf(line, sizeof(line), "%d games in %.1f s, %.0f games/hour\n",
+                  games, seconds, games * 3600.0 / std::max(seconds, 1e-9));
+    std::cout << line;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    MatchOptions options;
+    options.players[0].name = "A";
+    options.players[1].name = "B";
+    options.players[0].limits.nodes = options.players[1].limits.nodes = 20000;
+    std::string tracePath;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        bool ok = hasValue;
+        if (arg == "--games" && hasValue) options.games = std::atoi(argv[++i]);
+        else if (arg == "--threads" && hasValue) options.threads = std::atoi(argv[++i]);
+        else if (arg == "--a" && hasValue) ok = parsePlayer(argv[++i], options.players[0]);
+        else if (arg == "--b" && hasValue) ok = parsePlayer(argv[++i], options.players[1]);
+        else if (arg == "--random-plies" && hasValue) options.randomPlies = std::atoi(argv[++i]);
+        else if (arg == "--max-plies" && hasValue) options.maxPlies = std::atoi(argv[++i]);
+        else if (arg == "--seed" && hasValue) options.seed = std::strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--pdn" && hasValue) options.pdnPath = argv[++i];
+        else if (arg == "--jsonl" && hasValue) options.jsonlPath = argv[++i];
+        else if (arg == "--tb" && hasValue) options.tablebaseDirectory = argv[++i];
+        else if (arg == "--trace" && hasValue) tracePath = argv[++i];
+        else ok = false;
+
+        if (!ok) {
+            printUsage();
+            return 2;
+        }
+    }
+    options.threads = std::max(1, options.threads);
+
+    Tablebase tablebase;
+    const Tablebase* sharedTablebase = nullptr;
+    if (!options.tablebaseDirectory.empty()) {
+        int tables = tablebase.load(options.tablebaseDirectory, MAX_TABLEBASE_PIECES);
+        std::cout << "loaded " << tables << " tablebase files, up to " << tablebase.maxPieces() << " pieces" << std::endl;
+        sharedTablebase = &tablebase;
+    }
+
+    for (auto& player : options.players) {
+        if (!player.bookPath.empty() && !player.book.open(player.bookPath)) {
+            std::cerr << "cannot open book " << player.bookPath << std::endl;
+            return 1;
+        }
+    }
+
+    ResultSink sink(options);
+    if (!sink.isOpen()) {
+        std::cerr << "cannot open output file" << std::endl;
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::atomic<int> nextGame{0};
+    std::vector<std::thread> pool;
+    for (int t = 0; t < options.threads; ++t) {
+        pool.emplace_back([&]() {
+            Engine engineA(options.players[0].hashMegabytes, 1);
+            Engine engineB(options.players[1].hashMegabytes, 1);
+            Engine* engines[2] = {&engineA, &engineB};
+            while (true) {
+                int index = nextGame.fetch_add(1);
+                if (index >= options.games) break;
+
+                GameRecord game;
+                game.index = index;
+                game.whitePlayer = index % 2;
+                playGame(options, sharedTablebase, engines, game);
+                sink.add(game);
+            }
+        });
+    }
+    for (auto& thread : pool) thread.join();
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    printSummary(options, sink, seconds);
+    if (!tracePath.empty()) {
+        std::cout << profileSummary();
+        if (profilingEnabled() && !writeChromeTrace(tracePath)) std::cerr << "cannot write trace " << tracePath << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,165 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "game_state.h"
+#include "notation.h"
+#include "pdn.h"
+#include "position_index.h"
+
+namespace {
+
+void printUsage() {
+    std::cout << "usage: pdntool check FILE [--threads N]\n"
+              << "       pdntool index FILE [--out INDEX] [--threads N]\n"
+              << "       pdntool find FILE (--fen FEN | --moves \"c3-d4 ...\") [--index INDEX] [--limit N] [--threads N]\n"
+              << "       pdntool show FILE OFFSET\n";
+}
+
+double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Both notations are accepted: a FEN, or a move sequence from the start.
+bool targetPosition(const std::string& fen, const std::string& moves, Position& pos) {
+    pos = Position::initial();
+    if (!fen.empty()) return parseFen(fen, pos);
+
+    std::stringstream stream(moves);
+    std::string token;
+    while (stream >> token) {
+        Move move;
+        if (!parseMove(pos, token, move)) return false;
+        makeMove(pos, move);
+    }
+    return true;
+}
+
+void printStats(const PdnStats& stats, double seconds) {
+    std::cout << stats.games << " games, " << stats.moves << " moves, " << stats.invalidGames
+              << " invalid in " << seconds << " s" << std::endl;
+    if (!stats.firstError.empty()) {
+        std::cout << "first error at offset " << stats.firstErrorOffset << ": " << stats.firstError << std::endl;
+    }
+}
+
+void printGameLine(uint64_t offset, const PdnGame& game) {
+    std::cout << offset << "  " << game.tag("White") << " - " << game.tag("Black") << "  " << game.result
+              << "  " << game.moves.size() << " plies" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        printUsage();
+        return 2;
+    }
+    std::string command = argv[1];
+    std::string path = argv[2];
+    std::string indexPath = path + ".idx";
+    std::string fen;
+    std::string moves;
+    std::string offsetText;
+    int threads = 1;
+    size_t limit = 20;
+
+    for (int i = 3; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if ((arg == "--out" || arg == "--index") && hasValue) indexPath = argv[++i];
+        else if (arg == "--threads" && hasValue) threads = std::atoi(argv[++i]);
+        else if (arg == "--fen" && hasValue) fen = argv[++i];
+        else if (arg == "--moves" && hasValue) moves = argv[++i];
+        else if (arg == "--limit" && hasValue) limit = std::strtoul(argv[++i], nullptr, 10);
+        else if (command == "show" && offsetText.empty()) offsetText = arg;
+        else {
+            printUsage();
+            return 2;
+        }
+    }
+
+    PdnDatabase database;
+    if (!database.open(path)) {
+        std::cerr << "cannot open " << path << std::endl;
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    if (command == "check") {
+        PdnStats stats = database.forEachGame(threads, [](int, uint64_t, const PdnGame&) {});
+        printStats(stats, secondsSince(start));
+        return stats.invalidGames == 0 ? 0 : 1;
+    }
+
+    if (command == "index") {
+        PdnStats stats;
+        if (!buildPositionIndex(database, indexPath, threads, &stats)) {
+            std::cerr << "cannot write " << indexPath << std::endl;
+            return 1;
+        }
+        printStats(stats, secondsSince(start));
+        PositionIndex index;
+        if (index.open(indexPath)) std::cout << index.entryCount() << " positions indexed in " << indexPath << std::endl;
+        return 0;
+    }
+
+    if (command == "show") {
+        PdnGame game;
+        std::string error;
+        if (offsetText.empty() || !database.parseGameAt(std::strtoull(offsetText.c_str(), nullptr, 10), game, &error)) {
+            std::cerr << "cannot read game: " << error << std::endl;
+            return 1;
+        }
+        Position pos = game.start;
+        for (const auto& move : game.moves) makeMove(pos, move);
+        std::cout << formatPdn(game) << "final position: " << toFen(pos) << std::endl;
+        return 0;
+    }
+
+    if (command != "find") {
+        printUsage();
+        return 2;
+    }
+
+    Position target;
+    if (!targetPosition(fen, moves, target)) {
+        std::cerr << "bad --fen or --moves" << std::endl;
+        return 2;
+    }
+    uint64_t key = GameState(target).hash();
+    std::vector<uint64_t> offsets;
+
+    PositionIndex index;
+    if (index.open(indexPath) && index.sourceSize() == database.size()) {
+        index.find(key, offsets);
+    } else {
+        std::cout << "no usable index at " << indexPath << ", scanning the whole file" << std::endl;
+        std::mutex mutex;
+        database.forEachGame(threads, [&](int, uint64_t offset, const PdnGame& game) {
+            GameState state(game.start);
+            bool reached = state.hash() == key;
+            for (size_t i = 0; i < game.moves.size() && !reached; ++i) {
+                state.makeMove(game.moves[i]);
+                reached = state.hash() == key;
+            }
+            if (!reached) return;
+            std::lock_guard<std::mutex> lock(mutex);
+            offsets.push_back(offset);
+        });
+        std::sort(offsets.begin(), offsets.end());
+    }
+    double lookupSeconds = secondsSince(start);
+
+    std::cout << offsets.size() << " games reach " << toFen(target) << " (" << lookupSeconds * 1000 << " ms)" << std::endl;
+    PdnGame game;
+    for (size_t i = 0; i < offsets.size() && i < limit; ++i) {
+        if (database.parseGameAt(offsets[i], game)) printGameLine(offsets[i], game);
+    }
+    return 0;
+}
@@ -0,0 +1,104 @@
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include "notation.h"
+#include "perft.h"
+
+namespace {
+
+void printUsage() {
+    std::cout << "usage: perft [--variant NAME] [--fen FEN] [--depth N] [--threads N] [--divide] [--expect NODES]\n"
+              << "  --variant  russian (default), international (10x10) or english\n"
+              << "  --fen      start position (default: initial position; russian only)\n"
+              << "  --depth    depth to count leaf nodes at (default: 6)\n"
+              << "  --threads  worker threads, root moves are split across them (default: all cores)\n"
+              << "  --divide   print the node count below every root move (russian only)\n"
+              << "  --expect   exit with status 1 if the total differs\n";
+}
+
+// Counts from the initial position of a variant without FEN or notation.
+template <typename Variant>
+uint64_t countVariant(int depth, int threads) {
+    return variantPerftParallel<Variant>(Variant::PositionType::initial(), depth, threads);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Position pos = Position::initial();
+    int depth = 6;
+    int threads = static_cast<int>(std::thread::hardware_concurrency());
+    bool divide = false;
+    bool fen = false;
+    long long expected = -1;
+    std::string variant = "russian";
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--fen" && hasValue) {
+            if (!parseFen(argv[++i], pos)) {
+                std::cerr << "invalid FEN: " << argv[i] << std::endl;
+                return 2;
+            }
+            fen = true;
+        } else if (arg == "--depth" && hasValue) {
+            depth = std::atoi(argv[++i]);
+        } else if (arg == "--threads" && hasValue) {
+            threads = std::atoi(argv[++i]);
+        } else if (arg == "--divide") {
+            divide = true;
+        } else if (arg == "--variant" && hasValue) {
+            variant = argv[++i];
+        } else if (arg == "--expect" && hasValue) {
+            expected = std::atoll(argv[++i]);
+        } else {
+            printUsage();
+            return arg == "--help" ? 0 : 2;
+        }
+    }
+    if (threads < 1) threads = 1;
+    if (variant != "russian" && (fen || divide)) {
+        std::cerr << "--fen and --divide are russian only" << std::endl;
+        printUsage();
+        return 2;
+    }
+
+    std::vector<PerftDivide> results;
+    auto start = std::chrono::steady_clock::now();
+    uint64_t nodes;
+    if (variant == "russian") {
+        std::cout << "position " << toFen(pos) << "\n";
+        nodes = perftParallel(pos, depth, threads, &results);
+    } else if (variant == "international") {
+        nodes = countVariant<InternationalDraughts>(depth, threads);
+    } else if (variant == "english") {
+        nodes = countVariant<EnglishDraughts>(depth, threads);
+    } else {
+        printUsage();
+        return 2;
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    if (divide) {
+        for (const auto& result : results) {
+            std::cout << moveToString(result.move) << " " << result.nodes << "\n";
+        }
+    }
+
+    double seconds = elapsed.count();
+    std::cout << "depth " << depth << " nodes " << nodes
+              << " time " << seconds << "s"
+              << " nps " << static_cast<uint64_t>(seconds > 0 ? nodes / seconds : 0)
+              << " threads " << threads << std::endl;
+
+    if (expected >= 0 && nodes != static_cast<uint64_t>(expected)) {
+        std::cerr << "perft mismatch: expected " << expected << ", got " << nodes << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,148 @@
+#include <algorithm>
+#include <cstdlib>
+#include <random>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "eval.h"
+#include "mcts.h"
+#include "notation.h"
+#include "opening_book.h"
+#include "search.h"
+#include "tablebase.h"
+#include "zobrist.h"
+
+namespace {
+
+enum class Player { Human, Engine, Mcts };
+
+void printUsage() {
+    std::cout << "usage: play [--white human|engine|mcts] [--black human|engine|mcts] [--fen FEN]\n"
+              << "            [--movetime MS] [--depth N] [--hash MB] [--tree MB] [--threads N] [--tb DIR] [--book FILE]\n";
+}
+
+bool parsePlayer(const std::string& value, Player& player) {
+    if (value == "human") player = Player::Human;
+    else if (value == "engine") player = Player::Engine;
+    else if (value == "mcts") player = Player::Mcts;
+    else return false;
+    return true;
+}
+
+std::string formatScore(int score) {
+    if (score > MATE_BOUND) return "win in " + std::to_string(MATE_SCORE - score);
+    if (score < -MATE_BOUND) return "loss in " + std::to_string(MATE_SCORE + score);
+    return std::to_string(score);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Position pos = Position::initial();
+    Player whitePlayer = Player::Human;
+    Player blackPlayer = Player::Engine;
+    SearchLimits limits;
+    limits.moveTimeMs = 1000;
+    size_t hashMegabytes = 64;
+    size_t treeMegabytes = 256;
+    int threads = 1;
+    std::string tablebaseDirectory;
+    std::string bookPath;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        bool ok = hasValue;
+        if (arg == "--white" && hasValue) ok = parsePlayer(argv[++i], whitePlayer);
+        else if (arg == "--black" && hasValue) ok = parsePlayer(argv[++i], blackPlayer);
+        else if (arg == "--fen" && hasValue) ok = parseFen(argv[++i], pos);
+        else if (arg == "--movetime" && hasValue) limits.moveTimeMs = std::atoi(argv[++i]);
+        else if (arg == "--depth" && hasValue) limits.depth = std::atoi(argv[++i]);
+        else if (arg == "--hash" && hasValue) hashMegabytes = std::strtoul(argv[++i], nullptr, 10);
+        else if (arg == "--tree" && hasValue) treeMegabytes = std::strtoul(argv[++i], nullptr, 10);
+        else if (arg == "--threads" && hasValue) threads = std::atoi(argv[++i]);
+        else if (arg == "--tb" && hasValue) tablebaseDirectory = argv[++i];
+        else if (arg == "--book" && hasValue) bookPath = argv[++i];
+        else ok = false;
+
+        if (!ok) {
+            printUsage();
+            return 2;
+        }
+    }
+
+    Engine engine(hashMegabytes, threads);
+    MctsEngine mcts(treeMegabytes, threads);
+    Tablebase tablebase;
+    if (!tablebaseDirectory.empty()) {
+        int tables = tablebase.load(tablebaseDirectory, MAX_TABLEBASE_PIECES);
+        std::cout << "loaded " << tables << " tablebase files, up to " << tablebase.maxPieces() << " pieces" << std::endl;
+        engine.setTablebase(&tablebase);
+    }
+    OpeningBook book;
+    if (!bookPath.empty()) {
+        if (book.open(bookPath)) std::cout << "opening book with " << book.positionCount() << " positions" << std::endl;
+        else std::cout << "cannot open book " << bookPath << std::endl;
+    }
+    std::mt19937_64 rng(std::random_device{}());
+    std::vector<uint64_t> history;
+
+    while (true) {
+        std::cout << "\n" << boardToString(pos) << toFen(pos) << std::endl;
+
+        MoveList moves;
+        generateMoves(pos, moves);
+        if (moves.empty()) {
+            std::cout << (pos.sideToMove == PieceColor::White ? "Black" : "White") << " wins!" << std::endl;
+            return 0;
+        }
+
+        uint64_t key = hashPosition(pos);
+        if (std::count(history.begin(), history.end(), key) >= 2) {
+            std::cout << "Draw by threefold repetition." << std::endl;
+            return 0;
+        }
+        history.push_back(key);
+
+        Player player = pos.sideToMove == PieceColor::White ? whitePlayer : blackPlayer;
+        Move move;
+        if (player != Player::Human && book.pickMove(pos, rng(), move)) {
+            std::cout << "engine plays " << moveToString(move) << " (book)" << std::endl;
+        } else if (player == Player::Mcts) {
+            MctsResult result = mcts.search(pos, limits);
+            move = result.bestMove;
+            double rate = result.seconds > 0 ? result.playouts / result.seconds : 0;
+            std::cout << "mcts playouts " << result.playouts << " (" << static_cast<uint64_t>(rate) << "/s)"
+                      << " expected " << result.expectedScore << " tree " << result.treeNodes << " nodes "
+                      << result.treeBytes / (1024 * 1024) << "/" << mcts.arenaBytes() / (1024 * 1024) << " MB pv";
+            for (const auto& pvMove : result.pv) std::cout << " " << moveToString(pvMove);
+            std::cout << std::endl;
+            std::cout << "mcts plays " << moveToString(move) << std::endl;
+        } else if (player == Player::Engine) {
+            engine.setGameHistory(history);
+            SearchResult result = engine.search(pos, limits, [](const SearchResult& info) {
+                std::cout << "depth " << info.depth << " score " << formatScore(info.score)
+                          << " nodes " << info.nodes << " pv";
+                for (const auto& pvMove : info.pv) std::cout << " " << moveToString(pvMove);
+                std::cout << std::endl;
+            });
+            move = result.bestMove;
+            std::cout << "engine plays " << moveToString(move) << std::endl;
+        } else {
+            std::string line;
+            while (true) {
+                std::cout << (pos.sideToMove == PieceColor::White ? "White" : "Black") << " to move: " << std::flush;
+                if (!std::getline(std::cin, line) || line == "quit") return 0;
+                if (parseMove(pos, line, move)) break;
+                std::cout << "illegal or ambiguous move, legal moves:";
+                for (const auto& legal : moves) std::cout << " " << moveToString(legal);
+                std::cout << std::endl;
+            }
+        }
+
+        // Positions before a capture or man move cannot come back.
+        if (move.isCapture() || !(pos.kings & squareBit(move.from))) history.clear();
+        makeMove(pos, move);
+    }
+}
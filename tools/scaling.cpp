@@ -0,0 +1,97 @@
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "notation.h"
+#include "profiler.h"
+#include "search.h"
+
+namespace {
+
+// Initial position followed by positions taken from engine self-play at
+// moves 8, 16, 24 and 34.
+const char* const TEST_POSITIONS[] = {
+    "W:Wa1,c1,e1,g1,b2,d2,f2,h2,a3,c3,e3,g3:Bb6,d6,f6,h6,a7,c7,e7,g7,b8,d8,f8,h8",
+    "B:Wg1,e1,c1,a1,h2,f2,d2,g3,c3,a3,d4,a5:Bh4,e5,h6,b6,g7,e7,c7,a7,h8,f8,d8,b8",
+    "B:Wg1,e1,a1,h2,f2,b2,g3,c3,a3,g5,a5:Bh4,h6,d6,b6,g7,c7,a7,h8,d8,b8",
+    "B:Wg1,a1,h2,f2,b2,e3,a3,f4,b4,a5:Bg5,c5,h6,f6,d6,c7,a7,h8,d8,b8",
+    "B:Wg1,a1,f2,g3,e3,a3,f4,b4,a5:Bh4,e5,c5,h6,d6,b6,c7,a7,h8",
+};
+
+void printUsage() {
+    std::cout << "usage: scaling [--threads MAX] [--depth N] [--hash MB] [--trace FILE]\n"
+              << "  searches every test position to a fixed depth with 1..MAX threads\n"
+              << "  and reports time-to-depth, nodes/sec and speedup over one thread\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int maxThreads = static_cast<int>(std::thread::hardware_concurrency());
+    int depth = 14;
+    size_t hashMegabytes = 128;
+    std::string tracePath;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--threads" && i + 1 < argc) maxThreads = std::atoi(argv[++i]);
+        else if (arg == "--depth" && i + 1 < argc) depth = std::atoi(argv[++i]);
+        else if (arg == "--hash" && i + 1 < argc) hashMegabytes = std::strtoul(argv[++i], nullptr, 10);
+        else if (arg == "--trace" && i + 1 < argc) tracePath = argv[++i];
+        else {
+            printUsage();
+            return arg == "--help" ? 0 : 2;
+        }
+    }
+    if (maxThreads < 1) maxThreads = 1;
+
+    std::vector<Position> positions;
+    for (const char* fen : TEST_POSITIONS) {
+        Position pos;
+        if (!parseFen(fen, pos)) {
+            std::cerr << "bad test position: " << fen << std::endl;
+            return 1;
+        }
+        positions.push_back(pos);
+    }
+
+    SearchLimits limits;
+    limits.depth = depth;
+
+    std::printf("positions %zu depth %d hash %zuMB\n", positions.size(), depth, hashMegabytes);
+    std::printf("%8s %12s %14s %12s %10s %10s\n", "threads", "time(s)", "nodes", "nps", "speedup", "nps-gain");
+
+    double baseSeconds = 0;
+    double baseNps = 0;
+    Engine engine(hashMegabytes);
+    for (int threads = 1; threads <= maxThreads; ++threads) {
+        engine.setThreads(threads);
+
+        double seconds = 0;
+        uint64_t nodes = 0;
+        for (const auto& pos : positions) {
+            engine.newGame();
+            SearchResult result = engine.search(pos, limits);
+            seconds += result.seconds;
+            nodes += result.nodes;
+        }
+
+        double nps = seconds > 0 ? nodes / seconds : 0;
+        if (threads == 1) {
+            baseSeconds = seconds;
+            baseNps = nps;
+        }
+        std::printf("%8d %12.3f %14llu %12.0f %10.2f %10.2f\n", threads, seconds,
+                    static_cast<unsigned long long>(nodes), nps,
+                    seconds > 0 ? baseSeconds / seconds : 0, baseNps > 0 ? nps / baseNps : 0);
+    }
+
+    if (!tracePath.empty()) {
+        std::cout << profileSummary();
+        if (profilingEnabled() && !writeChromeTrace(tracePath)) std::cerr << "cannot write trace " << tracePath << std::endl;
+    }
+    return 0;
+}
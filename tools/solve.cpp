@@ -0,0 +1,127 @@
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "dfpn.h"
+#include "notation.h"
+#include "profiler.h"
+#include "tablebase.h"
+
+namespace {
+
+void printUsage() {
+    std::cout << "usage: solve [--fen FEN] [--plies N] [--hash MB] [--threads N] [--time MS] [--nodes N]\n"
+              << "             [--tb DIR] [--tree-nodes N] [--pdn FILE] [--check]\n"
+              << "             [--trace FILE]\n"
+              << "  proves a forced win for the side to move within N plies (default 40)\n"
+              << "  --pdn   writes the proof tree, the defender's replies as variations\n"
+              << "  --check walks the proof tree and fails unless the win is proven in full\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Position pos = Position::initial();
+    SearchLimits limits;
+    limits.depth = 40;
+    size_t hashMegabytes = 256;
+    int threads = 1;
+    size_t treeNodes = 100000;
+    std::string tablebaseDirectory;
+    std::string pdnPath;
+    std::string tracePath;
+    bool check = false;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--check") {
+            check = true;
+            continue;
+        }
+        bool hasValue = i + 1 < argc;
+        bool ok = hasValue;
+        if (arg == "--fen" && hasValue) ok = parseFen(argv[++i], pos);
+        else if (arg == "--plies" && hasValue) limits.depth = std::atoi(argv[++i]);
+        else if (arg == "--hash" && hasValue) hashMegabytes = std::strtoul(argv[++i], nullptr, 10);
+        else if (arg == "--threads" && hasValue) threads = std::atoi(argv[++i]);
+        else if (arg == "--time" && hasValue) limits.moveTimeMs = std::atoi(argv[++i]);
+        else if (arg == "--nodes" && hasValue) limits.nodes = std::strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--tb" && hasValue) tablebaseDirectory = argv[++i];
+        else if (arg == "--tree-nodes" && hasValue) treeNodes = std::strtoul(argv[++i], nullptr, 10);
+        else if (arg == "--pdn" && hasValue) pdnPath = argv[++i];
+        else if (arg == "--trace" && hasValue) tracePath = argv[++i];
+        else ok = false;
+
+        if (!ok) {
+            printUsage();
+            return arg == "--help" ? 0 : 2;
+        }
+    }
+    if (limits.depth > MAX_PLY) {
+        std::cerr << "at most " << MAX_PLY << " plies" << std::endl;
+        return 2;
+    }
+
+    DfpnSolver solver(hashMegabytes, threads);
+    Tablebase tablebase;
+    if (!tablebaseDirectory.empty()) {
+        int tables = tablebase.load(tablebaseDirectory, MAX_TABLEBASE_PIECES);
+        std::cout << "loaded " << tables << " tablebase files, up to " << tablebase.maxPieces() << " pieces" << std::endl;
+        solver.setTablebase(&tablebase);
+    }
+
+    std::cout << boardToString(pos) << toFen(pos) << std::endl;
+    SolveResult result = solver.solve(pos, limits, treeNodes);
+
+    const char* side = pos.sideToMove == PieceColor::White ? "White" : "Black";
+    if (result.outcome == SolveOutcome::Win) {
+        std::cout << side << " wins within " << result.plies << " plies" << std::endl;
+    } else if (result.outcome == SolveOutcome::NoWin) {
+        std::cout << "no forced win for " << side << " within " << result.plies << " plies" << std::endl;
+    } else {
+        std::cout << "unsolved, stopped by a limit: proof number " << result.proofNumber
+                  << " disproof number " << result.disproofNumber << std::endl;
+    }
+    double nps = result.seconds > 0 ? result.nodes / result.seconds : 0;
+    std::cout << "nodes " << result.nodes << " time " << result.seconds << "s nps " << static_cast<uint64_t>(nps)
+              << " threads " << threads << std::endl;
+
+    if (result.outcome == SolveOutcome::Win) {
+        std::cout << "main line:";
+        for (const ProofNode* node = &result.tree; !node->children.empty(); node = &node->children.front()) {
+            std::cout << " " << moveToString(node->children.front().move);
+        }
+        std::cout << std::endl;
+        if (result.treeStatus == ProofTreeStatus::BudgetExhausted) {
+            std::cout << "proof tree cut off at " << treeNodes << " nodes" << std::endl;
+        } else if (result.treeStatus == ProofTreeStatus::Stopped) {
+            std::cout << "proof tree extraction stopped" << std::endl;
+        } else if (result.treeStatus == ProofTreeStatus::Failed) {
+            std::cout << "proof tree incomplete: a lost subtree could not be proven again" << std::endl;
+        }
+        if (check && (result.treeStatus != ProofTreeStatus::Complete ||
+                      !checkProofTree(pos, result.tree, result.plies))) {
+            std::cout << "proof tree check FAILED" << std::endl;
+            return 1;
+        }
+        if (!pdnPath.empty()) {
+            std::ofstream out(pdnPath);
+            out << formatProofTree(pos, result.tree);
+            if (!out) {
+                std::cerr << "cannot write " << pdnPath << std::endl;
+                return 1;
+            }
+        }
+    }
+
+    if (!tracePath.empty()) {
+        std::cout << profileSummary();
+        if (profilingEnabled() && !writeChromeTrace(tracePath)) std::cerr << "cannot write trace " << tracePath << std::endl;
+    }
+    if (check && result.outcome != SolveOutcome::Win) {
+        std::cout << "proof tree check FAILED: nothing proven" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,39 @@
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include "tablebase_generator.h"
+
+namespace {
+
+void printUsage() {
+    std::cout << "usage: tbgen [--pieces N] [--out DIR] [--threads N] [--distance]\n"
+              << "  --pieces    largest piece count to generate (default: 4)\n"
+              << "  --out       output directory, must exist (default: .)\n"
+              << "  --threads   worker threads (default: all cores)\n"
+              << "  --distance  also store distance-to-win in plies\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    TablebaseGeneratorOptions options;
+    options.threads = static_cast<int>(std::thread::hardware_concurrency());
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--pieces" && i + 1 < argc) options.maxPieces = std::atoi(argv[++i]);
+        else if (arg == "--out" && i + 1 < argc) options.directory = argv[++i];
+        else if (arg == "--threads" && i + 1 < argc) options.threads = std::atoi(argv[++i]);
+        else if (arg == "--distance") options.storeDistance = true;
+        else {
+            printUsage();
+            return arg == "--help" ? 0 : 2;
+        }
+    }
+    if (options.threads < 1) options.threads = 1;
+
+    options.log = [](const std::string& line) { std::cout << line << std::endl; };
+    return generateTablebases(options) ? 0 : 1;
+}
@@ -0,0 +1,304 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "eval.h"
+#include "eval_weights.h"
+#include "notation.h"
+#include "pdn.h"
+
+// Texel-style tuner for the linear evaluation. Positions are reduced to their
+// feature vectors once and kept as one int8 column per feature plus a result
+// column, so an epoch streams 6 bytes per position through a block loop the
+// compiler can vectorize, split across all threads.
+
+namespace {
+
+const size_t BLOCK = 512;
+const double LN10 = 2.302585092994046;
+
+struct TrainingSet {
+    std::vector<int8_t> columns[EVAL_FEATURES];
+    std::vector<uint8_t> results;   // White's score in half points: 0, 1 or 2
+
+    size_t size() const { return results.size(); }
+
+    void add(const Position& pos, uint8_t result) {
+        int features[EVAL_FEATURES];
+        evalFeatures(pos, features);
+        for (int f = 0; f < EVAL_FEATURES; ++f) columns[f].push_back(static_cast<int8_t>(features[f]));
+        results.push_back(result);
+    }
+
+    void append(TrainingSet& other) {
+        for (int f = 0; f < EVAL_FEATURES; ++f) {
+            columns[f].insert(columns[f].end(), other.columns[f].begin(), other.columns[f].end());
+            std::vector<int8_t>().swap(other.columns[f]);
+        }
+        results.insert(results.end(), other.results.begin(), other.results.end());
+        std::vector<uint8_t>().swap(other.results);
+    }
+};
+
+struct Partial {
+    double loss = 0;
+    double gradient[EVAL_FEATURES] = {};
+};
+
+void printUsage() {
+    std::cout << "usage: tune (--pdn FILE | --positions FILE) [--threads N] [--epochs N] [--lr X]\n"
+              << "            [--skip-plies N] [--max-positions N] [--header FILE]\n"
+              << "  --positions lines are \"FEN RESULT\" with RESULT 2-0, 1-1, 0-2, 1, 0.5 or 0\n";
+}
+
+double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+bool parseResult(const std::string& text, uint8_t& result) {
+    if (text == "2-0" || text == "1" || text == "1.0") result = 2;
+    else if (text == "1-1" || text == "0.5" || text == "1/2-1/2") result = 1;
+    else if (text == "0-2" || text == "0" || text == "0.0") result = 0;
+    else return false;
+    return true;
+}
+
+// Quiet positions of finished games, labeled with the final result; the first
+// plies are skipped since they mostly repeat across games.
+bool loadPdn(const std::string& path, int threads, int skipPlies, TrainingSet& set) {
+    PdnDatabase games;
+    if (!games.open(path)) return false;
+
+    std::vector<TrainingSet> perWorker(std::max(1, threads));
+    games.forEachGame(threads, [&](int worker, uint64_t, const PdnGame& game) {
+        uint8_t result;
+        if (!parseResult(game.result, result)) return;
+
+        Position pos = game.start;
+        for (size_t ply = 0; ply < game.moves.size(); ++ply) {
+            if (static_cast<int>(ply) >= skipPlies && !hasCapture(pos)) perWorker[worker].add(pos, result);
+            makeMove(pos, game.moves[ply]);
+        }
+    });
+    for (auto& part : perWorker) set.append(part);
+    return true;
+}
+
+bool loadPositions(const std::string& path, TrainingSet& set) {
+    std::ifstream in(path);
+    if (!in) return false;
+
+    std::string line;
+    while (std::getline(in, line)) {
+        size_t split = line.find_last_of(" \t");
+        if (split == std::string::npos) continue;
+        Position pos;
+        uint8_t result;
+        if (parseFen(line.substr(0, split), pos) && parseResult(line.substr(split + 1), result)) set.add(pos, result);
+    }
+    return true;
+}
+
+void evaluateRange(const TrainingSet& set, const double weights[EVAL_FEATURES], double scale,
+                   size_t begin, size_t end, Partial& out) {
+    float w[EVAL_FEATURES];
+    for (int f = 0; f < EVAL_FEATURES; ++f) w[f] = static_cast<float>(weights[f]);
+    float k = static_cast<float>(scale);
+
+    float eval[BLOCK];
+    float term[BLOCK];
+    for (size_t base = begin; base < end; base += BLOCK) {
+        size_t n = std::min(BLOCK, end - base);
+
+        for (size_t j = 0; j < n; ++j) eval[j] = 0;
+        for (int f = 0; f < EVAL_FEATURES; ++f) {
+            const int8_t* column = set.columns[f].data() + base;
+            for (size_t j = 0; j < n; ++j) eval[j] += w[f] * column[j];
+        }
+
+        const uint8_t* results = set.results.data() + base;
+        float loss = 0;
+        for (size_t j = 0; j < n; ++j) {
+            float s = 1.0f / (1.0f + std::exp(-k * eval[j]));
+            float error = s - 0.5f * results[j];
+            loss += error * error;
+            term[j] = error * s * (1.0f - s);
+        }
+        out.loss += loss;
+
+        for (int f = 0; f < EVAL_FEATURES; ++f) {
+            const int8_t* column = set.columns[f].data() + base;
+            float sum = 0;
+            for (size_t j = 0; j < n; ++j) sum += term[j] * column[j];
+            out.gradient[f] += sum;
+        }
+    }
+}
+
+// Mean squared error of sigmoid(scale * eval) against the results, and its
+// gradient with respect to the weights.
+Partial evaluateSet(const TrainingSet& set, const double weights[EVAL_FEATURES], double scale, int threads) {
+    threads = std::max(1, threads);
+    std::vector<Partial> partials(threads);
+    std::vector<std::thread> pool;
+    size_t size = set.size();
+    size_t blocks = (size + BLOCK - 1) / BLOCK;
+
+    for (int t = 0; t < threads; ++t) {
+        size_t begin = std::min(size, blocks * t / threads * BLOCK);
+        size_t end = std::min(size, blocks * (t + 1) / threads * BLOCK);
+        pool.emplace_back(evaluateRange, std::cref(set), weights, scale, begin, end, std::ref(partials[t]));
+    }
+    for (auto& thread : pool) thread.join();
+
+    Partial total;
+    for (const auto& partial : partials) {
+        total.loss += partial.loss;
+        for (int f = 0; f < EVAL_FEATURES; ++f) total.gradient[f] += partial.gradient[f];
+    }
+    double n = std::max<size_t>(1, size);
+    total.loss /= n;
+    for (auto& g : total.gradient) g *= 2 * scale / n;
+    return total;
+}
+
+// Fits the sigmoid scale to the starting weights, so training only moves the
+// weights relative to each other and to the data.
+double fitScale(const TrainingSet& set, const double weights[EVAL_FEATURES], int threads) {
+    double low = 0.05;
+    double high = 10.0;
+    for (int i = 0; i < 40; ++i) {
+        double a = low + (high - low) / 3;
+        double b = high - (high - low) / 3;
+        double lossA = evaluateSet(set, weights, a * LN10 / 400, threads).loss;
+        double lossB = evaluateSet(set, weights, b * LN10 / 400, threads).loss;
+        if (lossA < lossB) high = b;
+        else low = a;
+    }
+    return (low + high) / 2 * LN10 / 400;
+}
+
+bool writeHeader(const std::string& path, const int weights[EVAL_FEATURES], size_t positions, double loss) {
+    std::ofstream out(path);
+    if (!out) return false;
+
+    char summary[160];
+    std::snprintf(summary, sizeof(summary), "// Generated by tools/tune from %zu positions (loss %.6f); do not edit.\n",
+                  positions, loss);
+    out << summary
+        << "#ifndef EVAL_WEIGHTS_H\n#define EVAL_WEIGHTS_H\n\n#include \"eval.h\"\n\n"
+        << "const int EVAL_WEIGHTS[EVAL_FEATURES] = {\n";
+    for (int f = 0; f < EVAL_FEATURES; ++f) {
+        std::string value = std::to_string(weights[f]) + ",";
+        out << "    " << value << std::string(value.size() < 8 ? 8 - value.size() : 1, ' ')
+            << "// " << EVAL_FEATURE_NAMES[f] << "\n";
+    }
+    out << "};\n\n#endif // EVAL_WEIGHTS_H\n";
+    return static_cast<bool>(out);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::string pdnPath;
+    std::string positionsPath;
+    std::string headerPath;
+    int threads = std::max(1u, std::thread::hardware_concurrency());
+    int epochs = 200;
+    double learningRate = 1.0;
+    int skipPlies = 8;
+    size_t maxPositions = 0;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--pdn" && hasValue) pdnPath = argv[++i];
+        else if (arg == "--positions" && hasValue) positionsPath = argv[++i];
+        else if (arg == "--header" && hasValue) headerPath = argv[++i];
+        else if (arg == "--threads" && hasValue) threads = std::atoi(argv[++i]);
+        else if (arg == "--epochs" && hasValue) epochs = std::atoi(argv[++i]);
+        else if (arg == "--lr" && hasValue) learningRate = std::atof(argv[++i]);
+        else if (arg == "--skip-plies" && hasValue) skipPlies = std::atoi(argv[++i]);
+        else if (arg == "--max-positions" && hasValue) maxPositions = std::strtoull(argv[++i], nullptr, 10);
+        else {
+            printUsage();
+            return 2;
+        }
+    }
+    if (pdnPath.empty() == positionsPath.empty()) {
+        printUsage();
+        return 2;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    TrainingSet set;
+    bool loaded = pdnPath.empty() ? loadPositions(positionsPath, set) : loadPdn(pdnPath, threads, skipPlies, set);
+    if (!loaded) {
+        std::cerr << "cannot read " << (pdnPath.empty() ? positionsPath : pdnPath) << std::endl;
+        return 1;
+    }
+    if (maxPositions > 0 && set.size() > maxPositions) {
+        for (auto& column : set.columns) column.resize(maxPositions);
+        set.results.resize(maxPositions);
+    }
+    if (set.size() == 0) {
+        std::cerr << "no labeled positions" << std::endl;
+        return 1;
+    }
+    std::cout << "loaded " << set.size() << " positions (" << set.size() * (EVAL_FEATURES + 1) / (1 << 20)
+              << " MB packed) in " << secondsSince(start) << " s" << std::endl;
+
+    double weights[EVAL_FEATURES];
+    for (int f = 0; f < EVAL_FEATURES; ++f) weights[f] = EVAL_WEIGHTS[f];
+    double scale = fitScale(set, weights, threads);
+    std::cout << "sigmoid scale K = " << scale * 400 / LN10 << std::endl;
+
+    // Adam: the features differ in range by two orders of magnitude.
+    const double beta1 = 0.9;
+    const double beta2 = 0.999;
+    double moment[EVAL_FEATURES] = {};
+    double velocity[EVAL_FEATURES] = {};
+    Partial result = evaluateSet(set, weights, scale, threads);
+    std::cout << "initial loss " << result.loss << std::endl;
+
+    for (int epoch = 1; epoch <= epochs; ++epoch) {
+        auto epochStart = std::chrono::steady_clock::now();
+        for (int f = 0; f < EVAL_FEATURES; ++f) {
+            double g = result.gradient[f];
+            moment[f] = beta1 * moment[f] + (1 - beta1) * g;
+            velocity[f] = beta2 * velocity[f] + (1 - beta2) * g * g;
+            double m = moment[f] / (1 - std::pow(beta1, epoch));
+            double v = velocity[f] / (1 - std::pow(beta2, epoch));
+            weights[f] -= learningRate * m / (std::sqrt(v) + 1e-12);
+        }
+        result = evaluateSet(set, weights, scale, threads);
+
+        if (epoch % 10 == 0 || epoch == epochs) {
+            std::cout << "epoch " << epoch << " loss " << result.loss << " (" << secondsSince(epochStart) * 1000
+                      << " ms)";
+            for (int f = 0; f < EVAL_FEATURES; ++f) std::cout << " " << EVAL_FEATURE_NAMES[f] << "=" << weights[f];
+            std::cout << std::endl;
+        }
+    }
+
+    int rounded[EVAL_FEATURES];
+    for (int f = 0; f < EVAL_FEATURES; ++f) rounded[f] = static_cast<int>(std::lround(weights[f]));
+    if (!headerPath.empty()) {
+        if (!writeHeader(headerPath, rounded, set.size(), result.loss)) {
+            std::cerr << "cannot write " << headerPath << std::endl;
+            return 1;
+        }
+        std::cout << "wrote " << headerPath << std::endl;
+    }
+    return 0;
+}